@@ -0,0 +1,780 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "eight_puzzle_solver.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Corpus shipped next to the bench, CMake points it to the source tree
+#ifndef PUZZLE_BENCH_KORF
+#define PUZZLE_BENCH_KORF "bench/korf100.txt"
+#endif
+
+namespace
+{
+    constexpr std::size_t unknown = SIZE_MAX; ///< optimal length of instances which weren't solved before
+    constexpr auto eight_puzzle_budget = std::chrono::milliseconds(5); ///< time of anytime searches on the 8-puzzle
+    constexpr auto fifteen_puzzle_budget = std::chrono::milliseconds(500); ///< time of anytime searches on the 15-puzzle
+    constexpr std::size_t eight_puzzle_width = 10; ///< width of beam searches on the 8-puzzle
+    constexpr std::size_t fifteen_puzzle_width = 10000; ///< width of beam searches on the 15-puzzle
+
+    template <std::size_t Size>
+    struct Instance
+    {
+        std::string group; // name of the group in the report
+        GameBoard<Size> board; // initial board
+        std::size_t optimal; // length of the optimal solution, unknown if not given
+    };
+
+    template <std::size_t Size>
+    struct Corpus
+    {
+        GameBoard<Size> target{}; // target board of every instance
+        std::vector< Instance<Size> > instances{}; // instances in the order of groups
+    };
+
+    template <std::size_t Size>
+    struct Algorithm
+    {
+        std::string name; // name of the solver and the heuristic
+        std::function<Solution<Size>(const GameBoard<Size>&, const GameBoard<Size>&, SearchStats*)> solve;
+    };
+
+    struct Row
+    {
+        std::string algorithm{}; // name of the algorithm
+        std::string group{}; // name of the group of instances
+        std::size_t instances{ 0 }; // number of instances in the group
+        std::size_t solved{ 0 }; // number of instances with found solution
+        std::size_t optimal{ 0 }; // number of solutions with known optimal length
+        std::size_t excess{ 0 }; // sum of differences between found and optimal length
+        std::size_t length{ 0 }; // sum of solution lengths
+        double bound{ 1.0 }; // largest bound of suboptimality reported with the solutions
+        SearchStats stats{}; // sums of the counters, peaks and bytes are the largest ones
+        std::size_t peak_rss{ 0 }; // peak resident set size of the process in KB after the group
+    };
+
+    struct KernelRow
+    {
+        std::string metric{}; // name of the distance
+        std::size_t size{ 0 }; // size of the board
+        std::string implementation{}; // loop of GameBoard or instruction set of DistanceKernel
+        std::size_t evaluations{ 0 }; // number of computed distances
+        double seconds{ 0.0 }; // time of all evaluations
+        double checksum{ 0.0 }; // sum of distances, equal for every implementation of the metric
+    };
+
+    struct Options
+    {
+        std::string corpus{ "eight" }; // eight, korf or kernels
+        std::string korf{ PUZZLE_BENCH_KORF }; // file with instances of Korf's 15-puzzle corpus
+        std::string pdb{}; // file with pattern database for the 15-puzzle
+        std::string work_dir{}; // level files of the external search, directory in the system temporary one if empty
+        std::string output{ "-" }; // file for the report, "-" for standard output
+        std::string format{ "csv" }; // csv or json
+        std::vector<std::string> algorithms{}; // names of algorithms to run, default set if empty
+        std::size_t per_depth{ 10 }; // 8-puzzles of every depth
+        std::size_t limit{ SIZE_MAX }; // number of instances taken from the corpus
+        std::size_t threads{ std::thread::hardware_concurrency() }; // threads of parallel algorithms
+        std::uint64_t seed{ 1 }; // seed of the random generator
+        bool build_pdb{ false }; // build 6-6-3 database if the file is missing
+        bool measure_phases{ false }; // measure time of search phases, slows the searches down
+    };
+
+    /**
+    * \brief Returns peak resident set size of the process in KB
+    */
+    std::size_t peak_rss()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return 0;
+        }
+
+        return static_cast<std::size_t>(counters.PeakWorkingSetSize / 1024);
+#else
+        rusage usage{};
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss / 1024);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    template <std::size_t Size>
+    GameBoard<Size> make_board(const std::vector<std::size_t> &tiles)
+    {
+        auto labels = std::array< std::array< char, Size >, Size >{};
+
+        for (std::size_t cell = 0; cell < Size * Size; cell++)
+        {
+            labels[cell / Size][cell % Size] = tile_label(static_cast<std::uint8_t>(tiles[cell]));
+        }
+
+        return GameBoard<Size>(labels);
+    }
+
+    /**
+    * \brief Generates 8-puzzles grouped by the length of the optimal solution
+    *
+    * \details Breadth first search from the target finds every board together with its depth,
+    * then boards of each depth are sampled uniformly
+    */
+    Corpus<3> eight_puzzle_corpus(std::size_t per_depth, std::uint64_t seed)
+    {
+        auto corpus = Corpus<3>{};
+        corpus.target = make_board<3>({ 1, 2, 3, 4, 5, 6, 7, 8, 0 });
+
+        auto visited = VisitedBoards<3>(corpus.target);
+        auto level = std::vector< GameBoard<3> >{ corpus.target };
+        auto random = std::mt19937_64(seed);
+
+        visited.insert(corpus.target);
+
+        for (std::size_t depth = 0; !level.empty(); depth++)
+        {
+            auto sample = level;
+            std::shuffle(sample.begin(), sample.end(), random);
+            sample.resize(std::min(sample.size(), per_depth));
+
+            auto group = std::string(depth < 10 ? "depth-0" : "depth-") + std::to_string(depth);
+
+            for (const auto &board : sample)
+            {
+                corpus.instances.push_back({ group, board, depth });
+            }
+
+            auto next = std::vector< GameBoard<3> >{};
+
+            for (const auto &board : level)
+            {
+                for (Direction direction : { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT })
+                {
+                    auto temp = board.move(direction);
+
+                    if (temp.is_init() && visited.insert(temp))
+                    {
+                        next.push_back(temp);
+                    }
+                }
+            }
+
+            level.swap(next);
+        }
+
+        return corpus;
+    }
+
+    /**
+    * \brief Loads Korf's 15-puzzle instances
+    *
+    * \details Every line holds 16 tiles row by row with 0 for the blank,
+    * optionally preceded by the number of the instance and followed by the optimal length.
+    * Target has the blank in the first cell as in the original corpus.
+    */
+    bool korf_corpus(const std::string &path, Corpus<4> &corpus)
+    {
+        auto file = std::ifstream(path);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        corpus.target = make_board<4>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 });
+
+        for (std::string line; std::getline(file, line); )
+        {
+            auto stream = std::istringstream(line);
+            auto numbers = std::vector<std::size_t>{};
+
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            for (std::size_t number; stream >> number; )
+            {
+                numbers.push_back(number);
+            }
+
+            auto first = (numbers.size() > 16) ? numbers.begin() + 1 : numbers.begin();
+
+            if (numbers.size() < 16 || numbers.size() > 18)
+            {
+                return false;
+            }
+
+            auto tiles = std::vector<std::size_t>(first, first + 16);
+            auto optimal = (numbers.size() == 18) ? numbers.back() : unknown;
+            auto sorted = tiles;
+            std::sort(sorted.begin(), sorted.end());
+
+            for (std::size_t i = 0; i < sorted.size(); i++)
+            {
+                if (sorted[i] != i)
+                {
+                    return false;
+                }
+            }
+
+            corpus.instances.push_back({ "korf", make_board<4>(tiles), optimal });
+        }
+
+        return true;
+    }
+
+    std::vector< Algorithm<3> > eight_puzzle_algorithms(const MoveOracle<3> &oracle, const PatternDatabase<3> &database, std::size_t threads,
+        const std::string &directory)
+    {
+        return {
+            { "bfs", [](const auto &initial, const auto &target, SearchStats *stats) { return breadth_first_search(initial, target, stats); } },
+            { "parallel-bfs", [threads](const auto &initial, const auto &target, SearchStats *stats) { return parallel_breadth_first_search(initial, target, threads, stats); } },
+            { "bidirectional", [](const auto &initial, const auto &target, SearchStats *stats) { return bidirectional_search(initial, target, stats); } },
+            { "external-bfs", [directory](const auto &initial, const auto &target, SearchStats *stats) {
+                return external_breadth_first_search(initial, target, directory, ExternalBreadthFirstSearch<3>::default_memory, stats); } },
+            { "dfs", [](const auto &initial, const auto &target, SearchStats *stats) { return depth_first_search(initial, target, unlimited_depth, stats); } },
+            { "iddfs", [](const auto &initial, const auto &target, SearchStats *stats) { return iterative_deepening_search(initial, target, unlimited_depth, stats); } },
+            { "astar-manhattan", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::Manhattan, stats); } },
+            { "astar-euclidean", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::Euclidean, stats); } },
+            { "astar-chebyshev", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::Chebyshev, stats); } },
+            { "astar-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::LinearConflict, stats); } },
+            { "astar-walking-distance", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::WalkingDistance, stats); } },
+            { "astar-pdb", [&database](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, database, stats); } },
+            { "anytime-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) {
+                return anytime_A_star(initial, target, DistanceType::LinearConflict, SearchBudget{ eight_puzzle_budget }, 3.0f, stats); } },
+            { "beam-linear-conflict", [threads](const auto &initial, const auto &target, SearchStats *stats) {
+                return beam_search(initial, target, DistanceType::LinearConflict, eight_puzzle_width, threads, beam_depth_limit, stats); } },
+            { "ida-manhattan", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::Manhattan, stats); } },
+            { "ida-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::LinearConflict, stats); } },
+            { "ida-walking-distance", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::WalkingDistance, stats); } },
+            { "ida-pdb", [&database](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, database, stats); } },
+            { "hda-manhattan", [threads](const auto &initial, const auto &target, SearchStats *stats) { return HDA_star(initial, target, DistanceType::Manhattan, threads, stats); } },
+            { "oracle", [&oracle](const auto &initial, const auto &target, SearchStats *stats) { return oracle_search(initial, target, oracle, stats); } }
+        };
+    }
+
+    std::vector< Algorithm<4> > fifteen_puzzle_algorithms(const PatternDatabase<4> &database, std::size_t threads)
+    {
+        return {
+            { "astar-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, DistanceType::LinearConflict, stats); } },
+            { "astar-pdb", [&database](const auto &initial, const auto &target, SearchStats *stats) { return A_star(initial, target, database, stats); } },
+            { "anytime-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) {
+                return anytime_A_star(initial, target, DistanceType::LinearConflict, SearchBudget{ fifteen_puzzle_budget }, 3.0f, stats); } },
+            { "anytime-pdb", [&database](const auto &initial, const auto &target, SearchStats *stats) {
+                return anytime_A_star(initial, target, database, SearchBudget{ fifteen_puzzle_budget }, 3.0f, stats); } },
+            { "beam-linear-conflict", [threads](const auto &initial, const auto &target, SearchStats *stats) {
+                return beam_search(initial, target, DistanceType::LinearConflict, fifteen_puzzle_width, threads, beam_depth_limit, stats); } },
+            { "beam-pdb", [&database, threads](const auto &initial, const auto &target, SearchStats *stats) {
+                return beam_search(initial, target, database, fifteen_puzzle_width, threads, beam_depth_limit, stats); } },
+            { "ida-manhattan", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::Manhattan, stats); } },
+            { "ida-linear-conflict", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::LinearConflict, stats); } },
+            { "ida-walking-distance", [](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, DistanceType::WalkingDistance, stats); } },
+            { "ida-pdb", [&database](const auto &initial, const auto &target, SearchStats *stats) { return IDA_star(initial, target, database, stats); } },
+            { "hda-linear-conflict", [threads](const auto &initial, const auto &target, SearchStats *stats) { return HDA_star(initial, target, DistanceType::LinearConflict, threads, stats); } },
+            { "hda-pdb", [&database, threads](const auto &initial, const auto &target, SearchStats *stats) { return HDA_star(initial, target, database, threads, stats); } }
+        };
+    }
+
+    /**
+    * \brief Runs every selected algorithm on every instance of the corpus
+    *
+    * @return One row per algorithm and group of instances
+    */
+    template <std::size_t Size>
+    std::vector<Row> run(const Corpus<Size> &corpus, const std::vector< Algorithm<Size> > &algorithms, const Options &options)
+    {
+        auto rows = std::vector<Row>{};
+        const auto count = std::min(options.limit, corpus.instances.size());
+
+        for (const auto &algorithm : algorithms)
+        {
+            if (!options.algorithms.empty()
+                && std::find(options.algorithms.begin(), options.algorithms.end(), algorithm.name) == options.algorithms.end())
+            {
+                continue;
+            }
+
+            std::cerr << algorithm.name << '\n';
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const auto &instance = corpus.instances[i];
+
+                if (rows.empty() || rows.back().algorithm != algorithm.name || rows.back().group != instance.group)
+                {
+                    rows.push_back({ algorithm.name, instance.group });
+                }
+
+                auto &row = rows.back();
+                auto stats = SearchStats{};
+                stats.measure_phases = options.measure_phases;
+
+                const auto solution = algorithm.solve(instance.board, corpus.target, &stats);
+
+                row.stats.generated += stats.generated;
+                row.stats.expanded += stats.expanded;
+                row.stats.duplicates += stats.duplicates;
+                row.stats.evaluations += stats.evaluations;
+                row.stats.peak_open = std::max(row.stats.peak_open, stats.peak_open);
+                row.stats.peak_closed = std::max(row.stats.peak_closed, stats.peak_closed);
+                row.stats.bytes = std::max(row.stats.bytes, stats.bytes);
+                row.stats.move_seconds += stats.move_seconds;
+                row.stats.heuristic_seconds += stats.heuristic_seconds;
+                row.stats.dedup_seconds += stats.dedup_seconds;
+                row.stats.total_seconds += stats.total_seconds;
+                ++row.instances;
+
+                if (solution.is_found() && solution.board() == corpus.target)
+                {
+                    ++row.solved;
+                    row.length += solution.length();
+                    row.bound = std::max(row.bound, solution.bound());
+
+                    if (instance.optimal != unknown)
+                    {
+                        ++row.optimal;
+                        row.excess += solution.length() - std::min(solution.length(), instance.optimal);
+                    }
+                }
+
+                row.peak_rss = peak_rss();
+            }
+        }
+
+        return rows;
+    }
+
+    /**
+    * \brief Measures throughput of distance computations on random boards
+    *
+    * \details Every metric is computed by the loops of GameBoard
+    * and by DistanceKernel with every instruction set supported by the processor.
+    * Boards aren't required to be solvable, only the distance is computed.
+    */
+    template <std::size_t Size>
+    void benchmark_kernels(std::size_t boards, std::uint64_t seed, std::vector<KernelRow> &rows)
+    {
+        using Loop = float(*)(const GameBoard<Size>&, const GameBoard<Size>&);
+        using Kernel = float(DistanceKernel<Size>::*)(const GameBoard<Size>&) const noexcept;
+
+        struct Metric
+        {
+            const char *name;
+            Loop loop;
+            Kernel kernel;
+        };
+
+        const Metric metrics[] = {
+            { "manhattan", GameBoard<Size>::manhattan_distance, &DistanceKernel<Size>::manhattan },
+            { "euclidean", GameBoard<Size>::euclidean_distance, &DistanceKernel<Size>::euclidean },
+            { "chebyshev", GameBoard<Size>::chebyshev_distance, &DistanceKernel<Size>::chebyshev }
+        };
+
+        auto random = std::mt19937_64(seed);
+        auto tiles = std::vector<std::size_t>(Size * Size);
+        auto instances = std::vector< GameBoard<Size> >{};
+
+        std::iota(tiles.begin(), tiles.end(), 0);
+        const auto target = make_board<Size>(tiles);
+
+        for (std::size_t i = 0; i < boards; i++)
+        {
+            std::shuffle(tiles.begin(), tiles.end(), random);
+            instances.push_back(make_board<Size>(tiles));
+        }
+
+        // Enough rounds to run each measurement for a noticeable time
+        const std::size_t rounds = std::max<std::size_t>(1, 4000000 / std::max<std::size_t>(boards, 1));
+
+        const auto measure = [&](const char *metric, std::string implementation, auto distance)
+        {
+            auto row = KernelRow{ metric, Size, std::move(implementation) };
+            const auto start = std::chrono::steady_clock::now();
+
+            for (std::size_t round = 0; round < rounds; round++)
+            {
+                for (const auto &board : instances)
+                {
+                    row.checksum += distance(board);
+                }
+            }
+
+            row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            row.evaluations = rounds * instances.size();
+            rows.push_back(row);
+        };
+
+        for (const Metric &metric : metrics)
+        {
+            measure(metric.name, "loop", [&](const GameBoard<Size> &board) { return metric.loop(board, target); });
+
+            for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSSE3, SimdLevel::AVX2 })
+            {
+                const auto kernel = DistanceKernel<Size>(target, level);
+
+                // Level isn't available or the kernel falls back to a lower one which was measured already
+                if (kernel.level() != level)
+                {
+                    continue;
+                }
+
+                measure(metric.name, to_string(level), [&](const GameBoard<Size> &board) { return (kernel.*metric.kernel)(board); });
+            }
+        }
+    }
+
+    double evaluations_per_second(const KernelRow &row)
+    {
+        return row.seconds > 0.0 ? row.evaluations / row.seconds : 0.0;
+    }
+
+    /**
+    * \brief Returns throughput of the row relative to the loop of the same metric and size
+    */
+    double speedup(const std::vector<KernelRow> &rows, const KernelRow &row)
+    {
+        for (const KernelRow &loop : rows)
+        {
+            if (loop.metric == row.metric && loop.size == row.size && loop.implementation == "loop")
+            {
+                return evaluations_per_second(loop) > 0.0 ? evaluations_per_second(row) / evaluations_per_second(loop) : 0.0;
+            }
+        }
+
+        return 0.0;
+    }
+
+    void write_csv(const std::vector<KernelRow> &rows, std::ostream &stream)
+    {
+        stream << "metric,size,implementation,evaluations,seconds,evaluations_per_second,speedup,checksum\n";
+
+        for (const KernelRow &row : rows)
+        {
+            stream << row.metric << ',' << row.size << ',' << row.implementation << ',' << row.evaluations << ','
+                << row.seconds << ',' << evaluations_per_second(row) << ',' << speedup(rows, row) << ',' << row.checksum << '\n';
+        }
+    }
+
+    void write_json(const std::vector<KernelRow> &rows, std::ostream &stream)
+    {
+        stream << "[\n";
+
+        for (std::size_t i = 0; i < rows.size(); i++)
+        {
+            const KernelRow &row = rows[i];
+
+            stream << "  {\"metric\": \"" << row.metric << "\", \"size\": " << row.size
+                << ", \"implementation\": \"" << row.implementation << "\", \"evaluations\": " << row.evaluations
+                << ", \"seconds\": " << row.seconds << ", \"evaluations_per_second\": " << evaluations_per_second(row)
+                << ", \"speedup\": " << speedup(rows, row) << ", \"checksum\": " << row.checksum << '}'
+                << (i + 1 < rows.size() ? "," : "") << '\n';
+        }
+
+        stream << "]\n";
+    }
+
+    double mean_length(const Row &row)
+    {
+        return row.solved > 0 ? static_cast<double>(row.length) / row.solved : 0.0;
+    }
+
+    double nodes_per_second(const Row &row)
+    {
+        return row.stats.total_seconds > 0.0 ? row.stats.expanded / row.stats.total_seconds : 0.0;
+    }
+
+    void write_csv(const std::vector<Row> &rows, std::ostream &stream)
+    {
+        stream << "algorithm,group,instances,solved,optimal_known,excess_length,mean_length,max_bound,nodes_per_second,peak_rss_kb,";
+        write_csv_header(stream);
+        stream << '\n';
+
+        for (const Row &row : rows)
+        {
+            stream << row.algorithm << ',' << row.group << ',' << row.instances << ',' << row.solved << ','
+                << row.optimal << ',' << row.excess << ',' << mean_length(row) << ',' << row.bound << ','
+                << nodes_per_second(row) << ',' << row.peak_rss << ',';
+            write_csv(stream, row.stats);
+            stream << '\n';
+        }
+    }
+
+    void write_json(const std::vector<Row> &rows, std::ostream &stream)
+    {
+        stream << "[\n";
+
+        for (std::size_t i = 0; i < rows.size(); i++)
+        {
+            const Row &row = rows[i];
+
+            stream << "  {\"algorithm\": \"" << row.algorithm << "\", \"group\": \"" << row.group << '"'
+                << ", \"instances\": " << row.instances << ", \"solved\": " << row.solved
+                << ", \"optimal_known\": " << row.optimal << ", \"excess_length\": " << row.excess
+                << ", \"mean_length\": " << mean_length(row) << ", \"max_bound\": " << row.bound << ", \"nodes_per_second\": " << nodes_per_second(row)
+                << ", \"peak_rss_kb\": " << row.peak_rss << ", \"stats\": ";
+            write_json(stream, row.stats);
+            stream << '}' << (i + 1 < rows.size() ? "," : "") << '\n';
+        }
+
+        stream << "]\n";
+    }
+
+    void show_usage()
+    {
+        std::cerr << "Usage: puzzle_bench [--corpus eight|korf|kernels] [--korf FILE] [--pdb FILE] [--build-pdb] [--phases]\n"
+                     "                    [--algorithms NAME,...] [--per-depth N] [--limit N] [--threads N] [--work-dir DIR]\n"
+                     "                    [--seed N] [--format csv|json] [--output FILE]\n"
+                     "Runs solvers over a corpus and reports search statistics, peak RSS and lengths against the optimal ones.\n"
+                     "eight: random 8-puzzles grouped by optimal depth, per-depth of every depth.\n"
+                     "korf: 15-puzzles from the file, one instance per line: [number] 16 tiles [optimal length],\n"
+                     "Korf's 100 instances with their optimal lengths by default.\n"
+                     "Pattern databases of the 15-puzzle are loaded from --pdb, --build-pdb builds 6-6-3 partition\n"
+                     "and saves it to the --pdb file if one is given. Peak RSS is the high-water mark of the process.\n"
+                     "external-bfs keeps its levels in --work-dir (a fresh temporary directory by default),\n"
+                     "the first instance builds them and the others reuse them.\n"
+                     "anytime searches get a fixed budget of time. max_bound is the largest bound of suboptimality reported,\n"
+                     "beam and depth first searches divide the length by the heuristic distance of the initial board.\n"
+                     "beam searches keep a fixed width, excess_length shows how far their solutions are from the shortest ones.\n"
+                     "--phases measures time of move generation, heuristic and duplicate detection at some cost of speed.\n"
+                     "kernels: throughput of distance loops against vectorized kernels on --limit random 15- and 24-puzzles.\n";
+    }
+
+    bool parse_options(int argc, char *argv[], Options &options)
+    {
+        try
+        {
+            for (int i = 1; i < argc; i++)
+            {
+                const auto argument = std::string(argv[i]);
+                const bool has_value = i + 1 < argc;
+
+                if (argument == "--build-pdb")
+                {
+                    options.build_pdb = true;
+                }
+                else if (argument == "--phases")
+                {
+                    options.measure_phases = true;
+                }
+                else if (!has_value)
+                {
+                    return false;
+                }
+                else if (argument == "--corpus")
+                {
+                    options.corpus = argv[++i];
+                }
+                else if (argument == "--korf")
+                {
+                    options.korf = argv[++i];
+                }
+                else if (argument == "--pdb")
+                {
+                    options.pdb = argv[++i];
+                }
+                else if (argument == "--work-dir")
+                {
+                    options.work_dir = argv[++i];
+                }
+                else if (argument == "--output")
+                {
+                    options.output = argv[++i];
+                }
+                else if (argument == "--format")
+                {
+                    options.format = argv[++i];
+                }
+                else if (argument == "--per-depth")
+                {
+                    options.per_depth = std::stoul(argv[++i]);
+                }
+                else if (argument == "--limit")
+                {
+                    options.limit = std::stoul(argv[++i]);
+                }
+                else if (argument == "--threads")
+                {
+                    options.threads = std::stoul(argv[++i]);
+                }
+                else if (argument == "--seed")
+                {
+                    options.seed = std::stoull(argv[++i]);
+                }
+                else if (argument == "--algorithms")
+                {
+                    auto names = std::istringstream(argv[++i]);
+
+                    for (std::string name; std::getline(names, name, ','); )
+                    {
+                        options.algorithms.push_back(name);
+                    }
+                }
+                else
+                {
+                    return false;
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        return (options.corpus == "eight" || options.corpus == "korf" || options.corpus == "kernels") && (options.format == "csv" || options.format == "json");
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    auto options = Options{};
+    auto rows = std::vector<Row>{};
+    auto kernel_rows = std::vector<KernelRow>{};
+
+    if (!parse_options(argc, argv, options))
+    {
+        show_usage();
+        return 1;
+    }
+
+    if (options.corpus == "kernels")
+    {
+        const auto boards = std::min<std::size_t>(options.limit, 10000);
+
+        benchmark_kernels<4>(boards, options.seed, kernel_rows);
+        benchmark_kernels<5>(boards, options.seed, kernel_rows);
+    }
+    else if (options.corpus == "eight")
+    {
+        const auto corpus = eight_puzzle_corpus(options.per_depth, options.seed);
+        const auto oracle = MoveOracle<3>::build(corpus.target);
+        const auto database = PatternDatabase<3>::build(corpus.target, PatternDatabase<3>::partition(corpus.target, { 4, 4 }));
+
+        auto directory = options.work_dir;
+
+        if (directory.empty())
+        {
+            // Levels left by an earlier run would turn every instance into a lookup
+            auto error = std::error_code{};
+            directory = (std::filesystem::temp_directory_path(error) / "puzzle_bench_external").string();
+            std::filesystem::remove_all(directory, error);
+        }
+
+        rows = run(corpus, eight_puzzle_algorithms(oracle, database, options.threads, directory), options);
+    }
+    else
+    {
+        auto corpus = Corpus<4>{};
+
+        if (!korf_corpus(options.korf, corpus))
+        {
+            std::cerr << "Can't read instances from '" << options.korf << "'\n";
+            return 1;
+        }
+
+        auto database = options.pdb.empty() ? PatternDatabase<4>{} : PatternDatabase<4>::load(options.pdb);
+
+        if (!database.matches(corpus.target) && options.build_pdb)
+        {
+            std::cerr << "building 6-6-3 pattern database\n";
+            database = PatternDatabase<4>::build(corpus.target, PatternDatabase<4>::partition(corpus.target, { 6, 6, 3 }));
+
+            if (!options.pdb.empty())
+            {
+                database.save(options.pdb);
+            }
+        }
+
+        auto algorithms = fifteen_puzzle_algorithms(database, options.threads);
+
+        // Without database the searches fall back to Manhattan distance, which is too weak for the corpus
+        if (!database.matches(corpus.target))
+        {
+            algorithms.erase(std::remove_if(algorithms.begin(), algorithms.end(),
+                [](const Algorithm<4> &algorithm) { return algorithm.name.find("pdb") != std::string::npos; }), algorithms.end());
+        }
+
+        // Uninformed and weakly informed searches don't finish on the corpus in reasonable time
+        if (options.algorithms.empty())
+        {
+            options.algorithms = { "ida-walking-distance", "ida-pdb" };
+        }
+
+        rows = run(corpus, algorithms, options);
+    }
+
+    auto file = std::ofstream{};
+
+    if (options.output != "-")
+    {
+        file.open(options.output, std::ios::trunc);
+
+        if (!file)
+        {
+            std::cerr << "Can't open " << options.output << '\n';
+            return 1;
+        }
+    }
+
+    auto &stream = (options.output != "-") ? static_cast<std::ostream&>(file) : std::cout;
+
+    if (options.corpus == "kernels")
+    {
+        options.format == "json" ? write_json(kernel_rows, stream) : write_csv(kernel_rows, stream);
+    }
+    else if (options.format == "json")
+    {
+        write_json(rows, stream);
+    }
+    else
+    {
+        write_csv(rows, stream);
+    }
+
+    return stream ? 0 : 1;
+}
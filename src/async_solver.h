@@ -0,0 +1,139 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ASYNC_SOLVER_H_
+#define ASYNC_SOLVER_H_
+
+#include "search_control.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+* \brief Handle of a search running on a thread pool
+*
+* \details Handle owns the result and shares the control with the running search.
+* Destroying the handle before the result is taken cancels the search, so abandoned queries don't hold workers.
+*
+* @tparam Result result of the search, usually Solution<Rows, Cols>
+*/
+template <typename Result>
+class SearchHandle
+{
+public:
+    SearchHandle(std::future<Result> future, std::shared_ptr<SearchControl> control)
+        : future_{ std::move(future) }, control_{ std::move(control) }
+    {}
+
+    SearchHandle(SearchHandle&&) noexcept = default;
+    SearchHandle& operator=(SearchHandle&&) noexcept = default;
+
+    ~SearchHandle()
+    {
+        if (future_.valid())
+        {
+            control_->cancel();
+        }
+    }
+
+    /**
+    * \brief Asks the search to stop, it returns not found result at the next expansion
+    */
+    void cancel() noexcept
+    {
+        control_->cancel();
+    }
+
+    /**
+    * \brief Checks whether the result is ready without blocking
+    */
+    bool is_ready() const
+    {
+        return wait_for(std::chrono::seconds(0));
+    }
+
+    /**
+    * \brief Waits for the result at most for the given time
+    *
+    * @return True if the result is ready, false otherwise
+    */
+    template <typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &timeout) const
+    {
+        return future_.wait_for(timeout) == std::future_status::ready;
+    }
+
+    /**
+    * \brief Waits for the result and takes it, may be called once
+    *
+    * \details Exception thrown by the search, for example std::bad_alloc, is rethrown here
+    */
+    Result get()
+    {
+        return future_.get();
+    }
+
+    /**
+    * \brief Returns why the search stopped, StopReason::None if it ran to its end
+    */
+    StopReason stop_reason() const noexcept
+    {
+        return control_->stop_reason();
+    }
+
+private:
+    std::future<Result> future_; ///< result of the search
+    std::shared_ptr<SearchControl> control_; ///< control shared with the running search
+};
+
+/**
+* \brief Runs the search on the thread pool
+*
+* \details Search is a function taking SearchControl*, which it passes on to one of the solvers, for example
+* [=](SearchControl *control) { return A_star(initial, target, DistanceType::Manhattan, nullptr, control); }.
+* Search is queued like any other task, so a fixed pool multiplexes any number of queries.
+*
+* @tparam Search function taking SearchControl* and returning the result
+*
+* @param pool pool which runs the search
+* @param search search itself
+* @param control cancellation token, progress callback and memory cap of the search
+*
+* @return Handle of the queued search
+*/
+template <typename Search>
+auto solve_async(ThreadPool &pool, Search search, std::shared_ptr<SearchControl> control = std::make_shared<SearchControl>())
+    -> SearchHandle< std::invoke_result_t<Search&, SearchControl*> >
+{
+    using Result = std::invoke_result_t<Search&, SearchControl*>;
+
+    // Task of the pool has to be copyable, the packaged task isn't
+    auto task = std::make_shared< std::packaged_task<Result()> >(
+        [search = std::move(search), control]() mutable { return search(control.get()); });
+    auto future = task->get_future();
+
+    pool.submit([task] { (*task)(); });
+
+    return { std::move(future), std::move(control) };
+}
+
+#endif // ASYNC_SOLVER_H_
@@ -0,0 +1,123 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BOARD_KEY_H_
+#define BOARD_KEY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+/**
+* \brief Packed encoding of the board
+*
+* \details Stores tile id of every cell in a fixed number of bits,
+* cells are laid out row by row starting from the lowest bits of the first word.
+* Tile never straddles two words, so 3x3 and 4x4 boards fit in a single uint64_t
+* and larger boards spill to several words.
+* Blank tile has id 0, hence all-zero key never describes a valid board
+* and is used as an empty marker by hash tables.
+*
+* @tparam Cells stands for the number of cells on the board
+*/
+template <std::size_t Cells>
+struct BoardKey
+{
+    static constexpr std::size_t bits = (Cells <= 16) ? 4 : ((Cells <= 32) ? 5 : 6); ///< bits per tile
+    static constexpr std::size_t tiles_per_word = 64 / bits; ///< tiles stored in one word
+    static constexpr std::size_t words = (Cells + tiles_per_word - 1) / tiles_per_word; ///< number of words
+    static constexpr std::uint64_t mask = (std::uint64_t{ 1 } << bits) - 1; ///< mask of a single tile
+
+    std::array<std::uint64_t, words> data{};
+
+    /**
+    * \brief Returns tile id stored in the given cell
+    */
+    std::uint8_t get(std::size_t cell) const noexcept
+    {
+        return static_cast<std::uint8_t>((data[cell / tiles_per_word] >> (cell % tiles_per_word * bits)) & mask);
+    }
+
+    /**
+    * \brief Stores tile id in the given cell
+    */
+    void set(std::size_t cell, std::uint8_t tile) noexcept
+    {
+        auto &word = data[cell / tiles_per_word];
+        auto shift = cell % tiles_per_word * bits;
+
+        word = (word & ~(mask << shift)) | (static_cast<std::uint64_t>(tile) << shift);
+    }
+
+    /**
+    * \brief Computes hash of the key
+    *
+    * \details Mixes all words with multiply-xorshift steps,
+    * so that nearby boards spread over the whole table
+    */
+    std::size_t hash() const noexcept
+    {
+        std::uint64_t result{ 0x9E3779B97F4A7C15ull };
+
+        for (std::uint64_t word : data)
+        {
+            result = (result ^ word) * 0xFF51AFD7ED558CCDull;
+            result ^= result >> 32;
+        }
+
+        result *= 0xC4CEB9FE1A85EC53ull;
+        result ^= result >> 29;
+
+        return static_cast<std::size_t>(result);
+    }
+
+    bool empty() const noexcept
+    {
+        for (std::uint64_t word : data)
+        {
+            if (word != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    friend bool operator==(const BoardKey &lhs, const BoardKey &rhs) noexcept
+    {
+        return lhs.data == rhs.data;
+    }
+
+    friend bool operator!=(const BoardKey &lhs, const BoardKey &rhs) noexcept
+    {
+        return lhs.data != rhs.data;
+    }
+
+    /**
+    * \brief Orders keys word by word starting from the first one
+    *
+    * \details Order has no meaning for the puzzle, it only lets sorted files of boards be merged
+    */
+    friend bool operator<(const BoardKey &lhs, const BoardKey &rhs) noexcept
+    {
+        return lhs.data < rhs.data;
+    }
+};
+
+#endif // BOARD_KEY_H_
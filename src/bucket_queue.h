@@ -0,0 +1,166 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BUCKET_QUEUE_H_
+#define BUCKET_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+* \brief Tie-breaking policy which prefers nodes with the larger path cost
+*
+* \details Among nodes with equal f the deepest one is closest to the goal by the heuristic,
+* so the search dives towards the goal on the last f layer
+*/
+struct LargerCostFirst
+{
+    static constexpr std::size_t tier(std::size_t, std::size_t g) noexcept
+    {
+        return g;
+    }
+};
+
+/**
+* \brief Tie-breaking policy which prefers nodes with the smaller path cost
+*/
+struct SmallerCostFirst
+{
+    static constexpr std::size_t tier(std::size_t f, std::size_t g) noexcept
+    {
+        return f - g;
+    }
+};
+
+/**
+* \brief Priority queue with small integer keys
+*
+* \details Nodes are kept in buckets indexed by f = g + h and then by the tier of the tie-breaking policy.
+* Pop returns node with the least f and the largest tier, nodes of the same tier are returned in LIFO order.
+* Every operation takes amortized constant time, since f values of the n-puzzle heuristics
+* are small integers which grow monotonically during the search.
+*
+* @tparam TieBreaking policy which maps f and g to the tier of the node
+*/
+template <typename TieBreaking = LargerCostFirst>
+class BucketQueue
+{
+public:
+    void push(std::size_t f, std::size_t g, std::uint32_t index)
+    {
+        if (f >= buckets_.size())
+        {
+            buckets_.resize(f + 1);
+        }
+
+        auto &bucket = buckets_[f];
+        const auto tier = TieBreaking::tier(f, g);
+
+        if (tier >= bucket.size())
+        {
+            bucket.resize(tier + 1);
+        }
+
+        bucket[tier].push_back(index);
+
+        if (f < min_f_)
+        {
+            min_f_ = f;
+        }
+
+        ++size_;
+    }
+
+    /**
+    * \brief Removes node with the least f and the largest tier
+    *
+    * \details Queue must not be empty
+    *
+    * @return Index of the removed node
+    */
+    std::uint32_t pop()
+    {
+        auto &bucket = buckets_[min_key()];
+        auto index = bucket.back().back();
+
+        bucket.back().pop_back();
+
+        // Keep the last tier non-empty
+        while (!bucket.empty() && bucket.back().empty())
+        {
+            bucket.pop_back();
+        }
+
+        --size_;
+
+        return index;
+    }
+
+    /**
+    * \brief Returns the least f in the queue
+    *
+    * \details Queue must not be empty
+    */
+    std::size_t min_key()
+    {
+        while (buckets_[min_f_].empty())
+        {
+            ++min_f_;
+        }
+
+        return min_f_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+    * \brief Returns number of bytes taken by the buckets
+    */
+    std::size_t memory() const noexcept
+    {
+        auto result = buckets_.capacity() * sizeof(buckets_[0]);
+
+        for (const auto &bucket : buckets_)
+        {
+            result += bucket.capacity() * sizeof(bucket[0]);
+
+            for (const auto &list : bucket)
+            {
+                result += list.capacity() * sizeof(list[0]);
+            }
+        }
+
+        return result;
+    }
+
+private:
+    std::vector< std::vector< std::vector<std::uint32_t> > > buckets_{}; ///< nodes indexed by f and then by tier
+    std::size_t min_f_{ SIZE_MAX }; ///< lower bound of the least f in the queue
+    std::size_t size_{ 0 }; ///< number of nodes in the queue
+};
+
+#endif // BUCKET_QUEUE_H_
@@ -0,0 +1,562 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DISTANCE_KERNEL_H_
+#define DISTANCE_KERNEL_H_
+
+#include "game_board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define N_PUZZLE_X86_64
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define N_PUZZLE_TARGET(isa)
+#else
+#define N_PUZZLE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+/**
+* \brief Instruction sets used by distance kernels, ordered from the weakest
+*/
+enum class SimdLevel
+{
+    Scalar, ///< plain loops, available everywhere
+    SSSE3, ///< 16 cells per instruction, byte shuffles look up goal coordinates
+    AVX2 ///< 32 cells per instruction, covers the whole 5x5 board at once
+};
+
+inline const char* to_string(SimdLevel level) noexcept
+{
+    switch (level)
+    {
+    case SimdLevel::SSSE3:
+        return "ssse3";
+
+    case SimdLevel::AVX2:
+        return "avx2";
+
+    default:
+        return "scalar";
+    }
+}
+
+/**
+* \brief Returns the best instruction set supported by the processor
+*
+* \details Processor is queried once. Kernels of every level are compiled
+* regardless of the compiler flags, so the same binary runs on older machines.
+*/
+inline SimdLevel simd_level() noexcept
+{
+    static const SimdLevel level = []
+    {
+#if defined(N_PUZZLE_X86_64) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4]{};
+
+        __cpuid(info, 0);
+        const int max_leaf = info[0];
+
+        __cpuid(info, 1);
+        const bool ssse3 = (info[2] & (1 << 9)) != 0;
+        const bool saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+        bool avx2 = false;
+
+        if (max_leaf >= 7 && saves_ymm)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        return avx2 ? SimdLevel::AVX2 : (ssse3 ? SimdLevel::SSSE3 : SimdLevel::Scalar);
+#elif defined(N_PUZZLE_X86_64)
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+
+        return __builtin_cpu_supports("ssse3") ? SimdLevel::SSSE3 : SimdLevel::Scalar;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }();
+
+    return level;
+}
+
+namespace
+{
+    /**
+    * \brief Coordinates compared by distance kernels
+    *
+    * \details Goal coordinates are indexed by tile id, so that a byte shuffle of the tiles
+    * gives the goal of every cell. Cells past the end of the board hold blank tiles.
+    */
+    template <std::size_t Lanes>
+    struct KernelTables
+    {
+        alignas(32) std::array<std::uint8_t, Lanes> goal_rows{}; ///< row of every tile on the target board
+        alignas(32) std::array<std::uint8_t, Lanes> goal_cols{}; ///< column of every tile on the target board
+        alignas(32) std::array<std::uint8_t, Lanes> cell_rows{}; ///< row of every cell
+        alignas(32) std::array<std::uint8_t, Lanes> cell_cols{}; ///< column of every cell
+        alignas(32) std::array<std::uint8_t, Lanes> squares{}; ///< square of every coordinate difference
+    };
+
+#ifdef N_PUZZLE_X86_64
+    N_PUZZLE_TARGET("ssse3")
+    inline __m128i ssse3_lookup(const std::uint8_t *table, __m128i ids, __m128i upper) noexcept
+    {
+        // pshufb only sees the low four bits of the index, ids above 15 take the upper half of the table
+        const __m128i low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table)), ids);
+        const __m128i high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table + 16)), ids);
+
+        return _mm_or_si128(_mm_andnot_si128(upper, low), _mm_and_si128(upper, high));
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline __m128i ssse3_difference(__m128i lhs, __m128i rhs, __m128i blank) noexcept
+    {
+        return _mm_andnot_si128(blank, _mm_sub_epi8(_mm_max_epu8(lhs, rhs), _mm_min_epu8(lhs, rhs)));
+    }
+
+    /**
+    * \brief Computes row and column differences of 16 cells starting from the given one
+    *
+    * \details Differences of blank tiles are cleared, so they don't contribute to any distance
+    */
+    N_PUZZLE_TARGET("ssse3")
+    inline void ssse3_differences(const KernelTables<32> &tables, const std::uint8_t *tiles, std::size_t first,
+        __m128i &rows, __m128i &cols) noexcept
+    {
+        const __m128i ids = _mm_load_si128(reinterpret_cast<const __m128i*>(tiles + first));
+        const __m128i upper = _mm_cmpgt_epi8(ids, _mm_set1_epi8(15));
+        const __m128i blank = _mm_cmpeq_epi8(ids, _mm_setzero_si128());
+
+        rows = ssse3_difference(ssse3_lookup(tables.goal_rows.data(), ids, upper),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(tables.cell_rows.data() + first)), blank);
+        cols = ssse3_difference(ssse3_lookup(tables.goal_cols.data(), ids, upper),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(tables.cell_cols.data() + first)), blank);
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline unsigned ssse3_sum(__m128i bytes) noexcept
+    {
+        // psadbw against zero leaves sums of both halves in the low words of the quadwords
+        const __m128i sums = _mm_sad_epu8(bytes, _mm_setzero_si128());
+
+        return static_cast<unsigned>(_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline float ssse3_sum(__m128 values) noexcept
+    {
+        values = _mm_add_ps(values, _mm_movehl_ps(values, values));
+        values = _mm_add_ss(values, _mm_shuffle_ps(values, values, 1));
+
+        return _mm_cvtss_f32(values);
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline float ssse3_manhattan(const KernelTables<32> &tables, const std::uint8_t *tiles, std::size_t blocks) noexcept
+    {
+        unsigned distance = 0;
+
+        for (std::size_t block = 0; block < blocks; block++)
+        {
+            __m128i rows, cols;
+            ssse3_differences(tables, tiles, block * 16, rows, cols);
+
+            distance += ssse3_sum(_mm_add_epi8(rows, cols));
+        }
+
+        return static_cast<float>(distance);
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline float ssse3_chebyshev(const KernelTables<32> &tables, const std::uint8_t *tiles, std::size_t blocks) noexcept
+    {
+        unsigned distance = 0;
+
+        for (std::size_t block = 0; block < blocks; block++)
+        {
+            __m128i rows, cols;
+            ssse3_differences(tables, tiles, block * 16, rows, cols);
+
+            distance += ssse3_sum(_mm_max_epu8(rows, cols));
+        }
+
+        return static_cast<float>(distance);
+    }
+
+    N_PUZZLE_TARGET("ssse3")
+    inline float ssse3_euclidean(const KernelTables<32> &tables, const std::uint8_t *tiles, std::size_t blocks) noexcept
+    {
+        const __m128i squares = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.squares.data()));
+        const __m128i zero = _mm_setzero_si128();
+        __m128 distance = _mm_setzero_ps();
+
+        for (std::size_t block = 0; block < blocks; block++)
+        {
+            __m128i rows, cols;
+            ssse3_differences(tables, tiles, block * 16, rows, cols);
+
+            // Squared lengths fit in a byte, they are widened to floats four at a time
+            const __m128i lengths = _mm_add_epi8(_mm_shuffle_epi8(squares, rows), _mm_shuffle_epi8(squares, cols));
+            const __m128i low = _mm_unpacklo_epi8(lengths, zero);
+            const __m128i high = _mm_unpackhi_epi8(lengths, zero);
+
+            distance = _mm_add_ps(distance, _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero))));
+            distance = _mm_add_ps(distance, _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero))));
+            distance = _mm_add_ps(distance, _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero))));
+            distance = _mm_add_ps(distance, _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero))));
+        }
+
+        return ssse3_sum(distance);
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline __m256i avx2_lookup(const std::uint8_t *table, __m256i ids, __m256i upper) noexcept
+    {
+        // vpshufb shuffles within 128-bit lanes, so both halves of the table are broadcast to both lanes
+        const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+        const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table + 16)));
+
+        return _mm256_blendv_epi8(_mm256_shuffle_epi8(low, ids), _mm256_shuffle_epi8(high, ids), upper);
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline __m256i avx2_difference(__m256i lhs, __m256i rhs, __m256i blank) noexcept
+    {
+        return _mm256_andnot_si256(blank, _mm256_sub_epi8(_mm256_max_epu8(lhs, rhs), _mm256_min_epu8(lhs, rhs)));
+    }
+
+    /**
+    * \brief Computes row and column differences of all 32 cells
+    */
+    N_PUZZLE_TARGET("avx2")
+    inline void avx2_differences(const KernelTables<32> &tables, const std::uint8_t *tiles, __m256i &rows, __m256i &cols) noexcept
+    {
+        const __m256i ids = _mm256_load_si256(reinterpret_cast<const __m256i*>(tiles));
+        const __m256i upper = _mm256_cmpgt_epi8(ids, _mm256_set1_epi8(15));
+        const __m256i blank = _mm256_cmpeq_epi8(ids, _mm256_setzero_si256());
+
+        rows = avx2_difference(avx2_lookup(tables.goal_rows.data(), ids, upper),
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(tables.cell_rows.data())), blank);
+        cols = avx2_difference(avx2_lookup(tables.goal_cols.data(), ids, upper),
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(tables.cell_cols.data())), blank);
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline unsigned avx2_sum(__m256i bytes) noexcept
+    {
+        const __m256i sums = _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+        const __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+
+        return static_cast<unsigned>(_mm_cvtsi128_si32(halves) + _mm_extract_epi16(halves, 4));
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline float avx2_manhattan(const KernelTables<32> &tables, const std::uint8_t *tiles) noexcept
+    {
+        __m256i rows, cols;
+        avx2_differences(tables, tiles, rows, cols);
+
+        return static_cast<float>(avx2_sum(_mm256_add_epi8(rows, cols)));
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline float avx2_chebyshev(const KernelTables<32> &tables, const std::uint8_t *tiles) noexcept
+    {
+        __m256i rows, cols;
+        avx2_differences(tables, tiles, rows, cols);
+
+        return static_cast<float>(avx2_sum(_mm256_max_epu8(rows, cols)));
+    }
+
+    N_PUZZLE_TARGET("avx2")
+    inline float avx2_euclidean(const KernelTables<32> &tables, const std::uint8_t *tiles) noexcept
+    {
+        __m256i rows, cols;
+        avx2_differences(tables, tiles, rows, cols);
+
+        const __m256i squares = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.squares.data())));
+        const __m256i lengths = _mm256_add_epi8(_mm256_shuffle_epi8(squares, rows), _mm256_shuffle_epi8(squares, cols));
+        const __m128i low = _mm256_castsi256_si128(lengths);
+        const __m128i high = _mm256_extracti128_si256(lengths, 1);
+
+        __m256 distance = _mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(low)));
+        distance = _mm256_add_ps(distance, _mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)))));
+        distance = _mm256_add_ps(distance, _mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(high))));
+        distance = _mm256_add_ps(distance, _mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)))));
+
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(distance), _mm256_extractf128_ps(distance, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+        return _mm_cvtss_f32(sum);
+    }
+#endif
+}
+
+/**
+* \brief Distances of whole boards to a fixed target
+*
+* \details Goal coordinates of every tile are laid out for byte shuffles once per target.
+* Distance of a board is then computed for 16 or 32 cells at once:
+* coordinate differences come from unsigned max minus min, psadbw sums them up.
+* Boards with more than 32 cells and processors without SSSE3 use scalar loops over the same tables.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class DistanceKernel
+{
+public:
+    DistanceKernel() = delete;
+
+    /**
+    * @param target board to which distances are computed
+    * @param level preferred instruction set, lowered to the one supported by the processor
+    */
+    explicit DistanceKernel(const GameBoard<Rows, Cols> &target, SimdLevel level = simd_level()) noexcept;
+
+    /**
+    * \brief Returns instruction set used by the kernel
+    */
+    SimdLevel level() const noexcept
+    {
+        return level_;
+    }
+
+    float manhattan(const GameBoard<Rows, Cols> &board) const noexcept;
+    float euclidean(const GameBoard<Rows, Cols> &board) const noexcept;
+    float chebyshev(const GameBoard<Rows, Cols> &board) const noexcept;
+
+private:
+    static constexpr std::size_t cells_ = Rows * Cols; ///< number of cells on the board
+    static constexpr std::size_t lanes_ = (cells_ <= 32) ? 32 : 64; ///< cells and tile ids covered by the tables
+    static constexpr std::size_t blocks_ = (cells_ + 15) / 16; ///< 16-cell blocks processed by SSSE3 kernels
+
+    using Tiles = std::array<std::uint8_t, lanes_>;
+
+    KernelTables<lanes_> tables_{}; ///< goal and cell coordinates
+    SimdLevel level_{ SimdLevel::Scalar }; ///< instruction set used by the kernel
+
+    void unpack(const GameBoard<Rows, Cols> &board, Tiles &tiles) const noexcept;
+
+    template <typename Metric>
+    float scalar(const Tiles &tiles, Metric metric) const noexcept;
+};
+
+template <std::size_t Rows, std::size_t Cols>
+DistanceKernel<Rows, Cols>::DistanceKernel(const GameBoard<Rows, Cols> &target, SimdLevel level) noexcept
+{
+    for (std::size_t cell = 0; cell < cells_; cell++)
+    {
+        auto tile = target.tile(cell);
+
+        tables_.cell_rows[cell] = static_cast<std::uint8_t>(cell / Cols);
+        tables_.cell_cols[cell] = static_cast<std::uint8_t>(cell % Cols);
+        tables_.goal_rows[tile] = static_cast<std::uint8_t>(cell / Cols);
+        tables_.goal_cols[tile] = static_cast<std::uint8_t>(cell % Cols);
+    }
+
+    for (std::size_t difference = 0; difference < (Rows > Cols ? Rows : Cols); difference++)
+    {
+        tables_.squares[difference] = static_cast<std::uint8_t>(difference * difference);
+    }
+
+    if (level > simd_level())
+    {
+        level = simd_level();
+    }
+
+    // Tables of larger boards don't fit in registers, a single block gains nothing from AVX2
+    if constexpr (lanes_ > 32)
+    {
+        level = SimdLevel::Scalar;
+    }
+    else if (blocks_ == 1 && level == SimdLevel::AVX2)
+    {
+        level = SimdLevel::SSSE3;
+    }
+
+    level_ = level;
+}
+
+/**
+* \brief Computes manhattan distance from the board to the target board
+*
+* \details Blank tile is not counted, so the distance never exceeds the number of moves
+*/
+template <std::size_t Rows, std::size_t Cols>
+float DistanceKernel<Rows, Cols>::manhattan(const GameBoard<Rows, Cols> &board) const noexcept
+{
+    alignas(32) Tiles tiles;
+    unpack(board, tiles);
+
+#ifdef N_PUZZLE_X86_64
+    if constexpr (lanes_ == 32)
+    {
+        if (level_ == SimdLevel::AVX2)
+        {
+            return avx2_manhattan(tables_, tiles.data());
+        }
+        else if (level_ == SimdLevel::SSSE3)
+        {
+            return ssse3_manhattan(tables_, tiles.data(), blocks_);
+        }
+    }
+#endif
+
+    return scalar(tiles, [](unsigned rows, unsigned cols) { return rows + cols; });
+}
+
+/**
+* \brief Computes euclidean distance from the board to the target board, blank tile is not counted
+*/
+template <std::size_t Rows, std::size_t Cols>
+float DistanceKernel<Rows, Cols>::euclidean(const GameBoard<Rows, Cols> &board) const noexcept
+{
+    alignas(32) Tiles tiles;
+    unpack(board, tiles);
+
+#ifdef N_PUZZLE_X86_64
+    if constexpr (lanes_ == 32)
+    {
+        if (level_ == SimdLevel::AVX2)
+        {
+            return avx2_euclidean(tables_, tiles.data());
+        }
+        else if (level_ == SimdLevel::SSSE3)
+        {
+            return ssse3_euclidean(tables_, tiles.data(), blocks_);
+        }
+    }
+#endif
+
+    return scalar(tiles, [this](unsigned rows, unsigned cols)
+    {
+        return std::sqrt(static_cast<float>(tables_.squares[rows] + tables_.squares[cols]));
+    });
+}
+
+/**
+* \brief Computes Chebyshev distance from the board to the target board, blank tile is not counted
+*/
+template <std::size_t Rows, std::size_t Cols>
+float DistanceKernel<Rows, Cols>::chebyshev(const GameBoard<Rows, Cols> &board) const noexcept
+{
+    alignas(32) Tiles tiles;
+    unpack(board, tiles);
+
+#ifdef N_PUZZLE_X86_64
+    if constexpr (lanes_ == 32)
+    {
+        if (level_ == SimdLevel::AVX2)
+        {
+            return avx2_chebyshev(tables_, tiles.data());
+        }
+        else if (level_ == SimdLevel::SSSE3)
+        {
+            return ssse3_chebyshev(tables_, tiles.data(), blocks_);
+        }
+    }
+#endif
+
+    return scalar(tiles, [](unsigned rows, unsigned cols) { return std::max(rows, cols); });
+}
+
+/**
+* \brief Spreads packed tiles of the board to one byte per cell
+*
+* \details Cells past the end of the board are filled with blank tiles
+*/
+template <std::size_t Rows, std::size_t Cols>
+void DistanceKernel<Rows, Cols>::unpack(const GameBoard<Rows, Cols> &board, Tiles &tiles) const noexcept
+{
+    const auto &key = board.key();
+
+#ifdef N_PUZZLE_X86_64
+    if constexpr (GameBoard<Rows, Cols>::Key::words == 1 && GameBoard<Rows, Cols>::Key::bits == 4)
+    {
+        // Low and high nibbles of every byte are neighbouring cells, interleaving them restores the order
+        const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(key.data.data()));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        const __m128i cells = _mm_unpacklo_epi8(_mm_and_si128(packed, mask), _mm_and_si128(_mm_srli_epi16(packed, 4), mask));
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(tiles.data()), cells);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tiles.data() + 16), _mm_setzero_si128());
+
+        return;
+    }
+#endif
+
+    using Key = typename GameBoard<Rows, Cols>::Key;
+
+    tiles.fill(0);
+
+    for (std::size_t word = 0, cell = 0; word < Key::words; word++)
+    {
+        auto bits = key.data[word];
+
+        for (std::size_t i = 0; i < Key::tiles_per_word && cell < cells_; i++, cell++)
+        {
+            tiles[cell] = static_cast<std::uint8_t>(bits & Key::mask);
+            bits >>= Key::bits;
+        }
+    }
+}
+
+template <std::size_t Rows, std::size_t Cols>
+template <typename Metric>
+float DistanceKernel<Rows, Cols>::scalar(const Tiles &tiles, Metric metric) const noexcept
+{
+    // Integer metrics are summed as integers, float additions would form a long dependency chain
+    decltype(metric(0u, 0u)) distance{};
+
+    for (std::size_t cell = 0; cell < cells_; cell++)
+    {
+        auto tile = tiles[cell];
+
+        if (tile == 0)
+        {
+            continue;
+        }
+
+        auto rows = static_cast<int>(tables_.goal_rows[tile]) - static_cast<int>(tables_.cell_rows[cell]);
+        auto cols = static_cast<int>(tables_.goal_cols[tile]) - static_cast<int>(tables_.cell_cols[cell]);
+
+        distance += metric(static_cast<unsigned>(std::abs(rows)), static_cast<unsigned>(std::abs(cols)));
+    }
+
+    return static_cast<float>(distance);
+}
+
+#endif // DISTANCE_KERNEL_H_
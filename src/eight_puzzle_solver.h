@@ -20,247 +20,2389 @@
 #define EIGHT_PUZZLE_SOLVER_
 
 #include "game_board.h"
+#include "state_set.h"
+#include "node_arena.h"
+#include "solution.h"
+#include "bucket_queue.h"
+#include "heuristic.h"
+#include "permutation.h"
+#include "move_oracle.h"
+#include "mpsc_queue.h"
+#include "thread_pool.h"
+#include "search_stats.h"
+#include "search_control.h"
+#include "external_search.h"
 
-#include <list>
 #include <vector>
 #include <array>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
+constexpr std::size_t unlimited_depth = SIZE_MAX; ///< depth limit of searches which go as deep as needed
+constexpr std::size_t beam_depth_limit = 1 << 12; ///< default number of levels of beam search, far above its usual solutions
 
-enum class DistanceType
+/**
+* \brief Limits of an anytime search
+*
+* \details Search returns the best solution found so far once either limit is reached,
+* default budget lets the search run until the solution is proven shortest
+*/
+struct SearchBudget
 {
-    Manhattan,
-    Euclidean,
-    Chebyshev
+    std::chrono::steady_clock::duration time{ std::chrono::steady_clock::duration::max() }; ///< wall time of the search
+    std::size_t nodes{ SIZE_MAX }; ///< number of expanded boards
 };
 
-
 namespace
 {
-    template <std::size_t Size>
-    using DistanceFunction = float(*)(const GameBoard<Size>&, const GameBoard<Size>&);
-
     const std::array<Direction, 4> directions = { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT };
 
-    template <std::size_t Size>
+    /**
+    * \brief Depth first search with explicit stack
+    *
+    * \details Board is changed in place, the current path is the stack of moves,
+    * so even the deepest paths take no call stack. Graph search remembers visited boards
+    * (with the depth they were reached at if depth is limited, so that shorter paths aren't cut off),
+    * tree search remembers nothing and only skips moves which undo the previous one.
+    */
+    template <std::size_t Rows, std::size_t Cols>
     class DepthFirstSearcher
     {
     public:
         DepthFirstSearcher() = delete;
 
-        DepthFirstSearcher(GameBoard<Size> target)
-            :target_(target)
+        DepthFirstSearcher(GameBoard<Rows, Cols> target, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+            :visited_(target), target_(target), timing_(stats != nullptr && stats->measure_phases ? &stats_ : nullptr), control_(control)
         {}
 
-        GameBoard<Size> find(const GameBoard<Size> &current)
+        /**
+        * \brief Finds any path not longer than max_depth
+        */
+        bool find(const GameBoard<Rows, Cols> &initial, std::size_t max_depth)
         {
-            if (!current.is_init()) // Check if move is possible
+            return search(initial, max_depth, false);
+        }
+
+        /**
+        * \brief Finds the shortest path by searching the tree with growing depth limit
+        */
+        bool find_shortest(const GameBoard<Rows, Cols> &initial, std::size_t max_depth)
+        {
+            for (std::size_t depth = 0; depth <= max_depth; depth++)
             {
-                return {};
+                if (search(initial, depth, true))
+                {
+                    return true;
+                }
             }
-            else if (current == target_) // Check if the goal is reached
+
+            return false;
+        }
+
+        const std::vector<Direction>& path() const noexcept
+        {
+            return path_;
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return stats_.generated;
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.peak_closed = std::max(visited_size_, depths_.size());
+            result.bytes = visited_.memory() + depths_.memory() + path_.capacity() * sizeof(Direction)
+                + next_.capacity() * sizeof(std::uint8_t);
+
+            return result;
+        }
+
+    private:
+        VisitedBoards<Rows, Cols> visited_; // all visited boards if depth isn't limited
+        StateMap<typename GameBoard<Rows, Cols>::Key, std::size_t> depths_{}; // least depth of every visited board if depth is limited
+        std::size_t visited_size_{ 0 }; // number of boards in visited_
+
+        GameBoard<Rows, Cols> board_{}; // the only board, which is changed in place
+        std::vector<Direction> path_{}; // moves from the initial board to the current one
+        std::vector<std::uint8_t> next_{}; // index of the next direction to try for every board on the path
+        GameBoard<Rows, Cols> target_{}; // target board
+
+        SearchStats stats_{}; // counters of the search, open list is the current path
+        SearchStats *timing_; // stats_ if phases are timed, nullptr otherwise
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+
+        // Marks the board as visited, returns false if it was reached before at the same or smaller depth
+        bool visit(std::size_t depth, std::size_t max_depth)
+        {
+            if (max_depth == unlimited_depth)
             {
-                return current;
+                if (!visited_.insert(board_))
+                {
+                    return false;
+                }
+
+                ++visited_size_;
+
+                return true;
             }
 
-            // Add board if it is unique
-            if (conditions_.end() == std::find(conditions_.begin(), conditions_.end(), current))
+            auto[least, inserted] = depths_.insert(board_.key(), depth);
+
+            if (!inserted && *least <= depth)
             {
-                conditions_.push_back(current);
+                return false;
             }
-            else
+
+            *least = depth;
+
+            return true;
+        }
+
+        bool search(const GameBoard<Rows, Cols> &initial, std::size_t max_depth, bool is_tree)
+        {
+            board_ = initial;
+            path_.clear();
+            next_.assign(1, 0);
+
+            if (!is_tree)
             {
-                return {};
+                visit(0, max_depth);
             }
 
-            GameBoard<Size> temp{};
+            if (board_ == target_)
+            {
+                return true;
+            }
 
-            for (Direction direction : directions)
+            while (!next_.empty())
             {
-                temp = find(current.move(direction));
+                stats_.peak_open = std::max(stats_.peak_open, next_.size());
+
+                // Go back once every direction was tried or the board is too deep to expand
+                if (next_.back() == directions.size() || path_.size() >= max_depth)
+                {
+                    next_.pop_back();
+
+                    if (!path_.empty())
+                    {
+                        board_.apply(opposite(path_.back()));
+                        path_.pop_back();
+                    }
+
+                    continue;
+                }
+
+                if (next_.back() == 0)
+                {
+                    if (is_stopped(control_, stats_.expanded,
+                        [&] { return SearchProgress{ stats_.expanded, stats_.generated, path_.size(), stats().bytes }; }))
+                    {
+                        return false;
+                    }
+
+                    ++stats_.expanded;
+                }
+
+                auto direction = directions[next_.back()++];
+
+                // Never undo the previous move
+                if (is_tree && !path_.empty() && direction == opposite(path_.back()))
+                {
+                    ++stats_.duplicates;
+                    continue;
+                }
+                else if (!measure(timing_, &SearchStats::move_seconds, [&] { return board_.apply(direction); }))
+                {
+                    continue;
+                }
+
+                ++stats_.generated;
+
+                if (!is_tree && !measure(timing_, &SearchStats::dedup_seconds, [&] { return visit(path_.size() + 1, max_depth); }))
+                {
+                    ++stats_.duplicates;
+                    board_.apply(opposite(direction));
+                    continue;
+                }
+
+                path_.push_back(direction);
+                next_.push_back(0);
 
                 // Check if the goal is reached
-                if (temp.is_init())
+                if (board_ == target_)
                 {
-                    return temp;
+                    return true;
                 }
             }
 
-            return {};
+            return false;
         }
-
-    private:
-        std::list<GameBoard<Size>> conditions_{}; // storage of all boards
-        GameBoard<Size> target_{}; // target board
     };
 
-    template <std::size_t Size>
-    DistanceFunction<Size> get_distance_function(DistanceType distance_type)
+    /**
+    * \brief Rounds heuristic value up to the integer key of the bucket queue
+    *
+    * \details Path cost is integer, so rounding admissible estimate up keeps it admissible
+    */
+    inline std::size_t heuristic_key(float distance)
     {
-        switch (distance_type)
-        {
-        case DistanceType::Manhattan:
-            return GameBoard<Size>::manhattan_distance;
-
-        case DistanceType::Euclidean:
-            return GameBoard<Size>::euclidean_distance;
+        return static_cast<std::size_t>(std::ceil(distance - 1e-3f));
+    }
 
-        case DistanceType::Chebyshev:
-            return GameBoard<Size>::chebyshev_distance;
+    /**
+    * \brief Returns bound of the ratio between the length of a solution and the shortest one
+    *
+    * \details Shortest solution is at least as long as the admissible distance of the initial board,
+    * bound is infinite if the distance says nothing
+    *
+    * @param length length of the found solution
+    * @param distance admissible distance of the initial board to the target
+    */
+    inline double length_bound(std::size_t length, float distance)
+    {
+        const auto least = heuristic_key(distance);
 
-        default:
-            return GameBoard<Size>::manhattan_distance;
+        if (length == 0)
+        {
+            return 1.0;
         }
+
+        return least == 0 ? std::numeric_limits<double>::infinity() : static_cast<double>(length) / least;
     }
 
-    template <std::size_t Size>
+    template <std::size_t Rows, std::size_t Cols, typename Distance, typename TieBreaking = LargerCostFirst>
     class AStarSearcher
     {
     public:
         AStarSearcher() = delete;
 
-        AStarSearcher(GameBoard<Size> target, DistanceType distance_type)
-            : target_{ target }, distance_function_{ get_distance_function<Size>(distance_type) }
+        AStarSearcher(GameBoard<Rows, Cols> target, const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr,
+            SearchControl *control = nullptr)
+            : target_{ target }, heuristic_{ target, database }, timing_{ stats != nullptr && stats->measure_phases ? &stats_ : nullptr }, control_{ control }
         {}
 
-        GameBoard<Size> find(const GameBoard<Size> &current)
+        std::uint32_t find(const GameBoard<Rows, Cols> &initial)
         {
-            if (!current.is_init()) // Check if move is possible
-            {
-                return {};
-            }
-            else if (current == target_) // Check if the goal is reached
-            {
-                return current;
-            }
+            auto distance = measure(timing_, &SearchStats::heuristic_seconds, [&] { return heuristic_.evaluate(initial); });
+            auto root = nodes_.push({ initial.key(), no_parent, {}, 0, distance });
+            closed_.insert(initial.key(), root);
+            open_.push(heuristic_key(distance), 0, root);
+            ++stats_.evaluations;
 
-            // Add board if it is unique
-            if (conditions_.end() == std::find(conditions_.begin(), conditions_.end(), current))
+            while (!open_.empty())
             {
-                conditions_.push_back(current);
+                stats_.peak_open = std::max(stats_.peak_open, open_.size());
+
+                auto index = open_.pop();
+                const auto node = nodes_[index];
+
+                // Skip the node if a shorter path to its board was found after it was queued
+                if (*closed_.find(node.key) != index)
+                {
+                    continue;
+                }
+
+                const auto current = GameBoard<Rows, Cols>(node.key);
+
+                // Check if the goal is reached
+                if (current == target_)
+                {
+                    return index;
+                }
+
+                if (is_stopped(control_, stats_.expanded,
+                    [&] { return SearchProgress{ stats_.expanded, stats_.generated, node.cost + heuristic_key(node.distance), stats().bytes }; }))
+                {
+                    return no_parent;
+                }
+
+                const auto blank = current.blank_cell();
+                ++stats_.expanded;
+
+                for (Direction direction : directions)
+                {
+                    // Check if move is possible before the board is built
+                    if (!BoardGeometry<Rows, Cols>::can_move(blank, direction))
+                    {
+                        continue;
+                    }
+
+                    auto temp = measure(timing_, &SearchStats::move_seconds, [&] { return current.move(direction); });
+                    ++stats_.generated;
+
+                    auto cost = static_cast<std::uint16_t>(node.cost + 1);
+                    auto[best, inserted] = measure(timing_, &SearchStats::dedup_seconds, [&] { return closed_.insert(temp.key(), 0); });
+
+                    // Reopen the board only if the new path is shorter
+                    if (!inserted && nodes_[*best].cost <= cost)
+                    {
+                        ++stats_.duplicates;
+                        continue;
+                    }
+
+                    auto distance = measure(timing_, &SearchStats::heuristic_seconds,
+                        [&] { return heuristic_.update(node.distance, temp, blank); });
+                    ++stats_.evaluations;
+
+                    *best = nodes_.push({ temp.key(), index, direction, cost, distance });
+                    open_.push(cost + heuristic_key(distance), cost, *best);
+                }
             }
-            else
+
+            return no_parent;
+        }
+
+        std::vector<Direction> path(std::uint32_t index) const
+        {
+            return trace_moves(nodes_, index);
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return nodes_.size();
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.peak_closed = closed_.size();
+            result.bytes = closed_.memory() + nodes_.memory() + open_.memory();
+
+            return result;
+        }
+
+    private:
+        StateMap<typename GameBoard<Rows, Cols>::Key, std::uint32_t> closed_{}; // index of the best node of every generated board
+        NodeArena< CostNode<Rows, Cols> > nodes_{}; // search tree
+        BucketQueue<TieBreaking> open_{}; // frontier ordered by f = g + h
+        GameBoard<Rows, Cols> target_{}; // target board
+
+        Distance heuristic_; // distance to the target board
+
+        SearchStats stats_{}; // counters of the search
+        SearchStats *timing_; // stats_ if phases are timed, nullptr otherwise
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+    };
+
+    /**
+    * \brief Anytime repairing A*
+    *
+    * \details Weighted A* is run with the decreasing weight, every pass reuses the tree of the previous one.
+    * Boards whose path got shorter after they were expanded in the current pass are kept aside
+    * and queued again with the next weight, so no board is expanded twice in one pass.
+    * Best solution and the bound of its suboptimality are known once the first pass reaches the target.
+    */
+    template <std::size_t Rows, std::size_t Cols, typename Distance>
+    class AnytimeSearcher
+    {
+    public:
+        AnytimeSearcher() = delete;
+
+        AnytimeSearcher(GameBoard<Rows, Cols> target, const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr,
+            SearchControl *control = nullptr)
+            : target_{ target }, heuristic_{ target, database }, timing_{ stats != nullptr && stats->measure_phases ? &stats_ : nullptr },
+            control_{ control }
+        {}
+
+        /**
+        * \brief Improves solution with decreasing weight until it is optimal or the budget runs out
+        *
+        * @return Index of the goal node of the best solution, no_parent if none was found or the control stopped the search
+        */
+        std::uint32_t find(const GameBoard<Rows, Cols> &initial, const SearchBudget &budget, float weight)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            deadline_ = budget.time < std::chrono::steady_clock::time_point::max() - now ? now + budget.time
+                : std::chrono::steady_clock::time_point::max();
+            max_expanded_ = budget.nodes;
+            weight_ = std::max(weight, 1.0f);
+
+            auto distance = measure(timing_, &SearchStats::heuristic_seconds, [&] { return heuristic_.evaluate(initial); });
+            auto root = nodes_.push({ initial.key(), no_parent, {}, 0, distance });
+            stamps_.push_back(0);
+            closed_.insert(initial.key(), root);
+            ++stats_.evaluations;
+
+            if (initial == target_)
             {
-                return {};
+                goal_ = root;
+
+                return goal_;
             }
 
-            std::vector<GameBoard<Size>> possible_boards{}; // possible boards from current board
-            std::vector<float> board_distances{}; // distances of possible boards
-            GameBoard<Size> temp{};
+            push(root);
 
-            // Getting all possible boards
-            // and their distances
-            for (Direction direction : directions)
+            while (improve())
             {
-                temp = current.move(direction);
+                proven_ = weight_;
+
+                if (bound() <= 1.0f)
+                {
+                    break;
+                }
 
-                if (temp.is_init())
+                // Next pass starts from every board left in the frontier or set aside
+                weight_ = std::max(1.0f, std::min(weight_ - weight_step_, bound()));
+                ++pass_;
+
+                for (auto index : incons_)
                 {
-                    possible_boards.push_back(temp);
-                    board_distances.push_back(distance_function_(temp, target_));
+                    push(index);
                 }
+
+                incons_.clear();
+                rekey();
             }
 
-            int size = possible_boards.size();
+            return goal_;
+        }
 
-            // Go down through all possible boards with respect
-            // to the value of distance function
-            for (int i = 0; i < size; i++)
+        /**
+        * \brief Returns bound of the ratio between length of the best solution and the shortest one
+        *
+        * \details Bound is the weight of the last completed pass or length of the solution
+        * divided by the least f of the frontier, whichever is tighter
+        */
+        float bound() const
+        {
+            if (goal_ == no_parent)
             {
-                // Get index of the element with the min distance
-                int index = std::min_element(board_distances.begin(), board_distances.end()) - board_distances.begin();
+                return proven_;
+            }
 
-                temp = find(possible_boards[index]);
+            auto least = static_cast<std::size_t>(nodes_[goal_].cost);
 
-                // Check if the solution is found
-                if (temp.is_init())
-                {
-                    return temp;
-                }
+            for (const auto &entry : open_)
+            {
+                least = std::min(least, f(entry.index));
+            }
 
-                // Erase checked elements
-                possible_boards.erase(std::remove(possible_boards.begin(), possible_boards.end(), possible_boards[index]),
-                    possible_boards.end());
-                board_distances.erase(std::remove(board_distances.begin(), board_distances.end(), board_distances[index]),
-                    board_distances.end());
+            for (auto index : incons_)
+            {
+                least = std::min(least, f(index));
             }
 
-            return {};
+            return least == 0 ? 1.0f : std::min(proven_, static_cast<float>(nodes_[goal_].cost) / least);
+        }
+
+        std::vector<Direction> path(std::uint32_t index) const
+        {
+            return trace_moves(nodes_, index);
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return nodes_.size();
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.peak_closed = closed_.size();
+            result.bytes = closed_.memory() + nodes_.memory() + open_.capacity() * sizeof(Entry)
+                + (incons_.capacity() + stamps_.capacity()) * sizeof(std::uint32_t);
+
+            return result;
         }
 
     private:
-        std::list<GameBoard<Size>> conditions_{}; // storage of all boards
-        GameBoard<Size> target_{}; // target board
+        struct Entry
+        {
+            float key; // g + w * h
+            std::uint16_t cost; // g, breaks ties of the key
+            std::uint32_t index; // node in the arena
+        };
 
-        DistanceFunction<Size> distance_function_{ nullptr };
-    };
-}
+        // Heap order, the top entry has the least key and the largest cost among equal keys
+        static bool after(const Entry &left, const Entry &right) noexcept
+        {
+            return left.key > right.key || (left.key == right.key && left.cost < right.cost);
+        }
 
-template <std::size_t Size>
-GameBoard<Size> breadth_first_search(const GameBoard<Size> &initial, const GameBoard<Size> &target)
-{
-    auto conditions = std::list< GameBoard<Size> >{ initial }; // storage of all boards
-    auto previous_level_board = 1; // number of boards added on previous level
-    auto current_level_board = 0; // number of boards on current level
+        static constexpr float weight_step_ = 0.5f; // decrease of the weight after every pass
+        static constexpr std::size_t clock_period_ = 1024; // number of expansions between looks at the clock
 
-    auto level_begin = std::next(conditions.end(), -previous_level_board); // iterator to the beginning of the current level
+        StateMap<typename GameBoard<Rows, Cols>::Key, std::uint32_t> closed_{}; // index of the best node of every generated board
+        NodeArena< CostNode<Rows, Cols> > nodes_{}; // search tree
+        std::vector<std::uint32_t> stamps_{}; // pass in which every node was expanded, 0 if it wasn't
+        std::vector<Entry> open_{}; // frontier of the current pass, binary heap so that it can be scanned for the bound
+        std::vector<std::uint32_t> incons_{}; // nodes reached by a shorter path after their board was expanded in the current pass
+        GameBoard<Rows, Cols> target_{}; // target board
 
-    auto temp = GameBoard<Size>{};
+        Distance heuristic_; // distance to the target board
 
-    for (int level = 1; ; level++, current_level_board = 0, level_begin = std::next(conditions.end(), -previous_level_board))
-    {
-        // Get childs from every board on the previous level
-        for (int i = 0; i < previous_level_board; ++i, ++level_begin)
+        std::uint32_t goal_{ no_parent }; // goal node of the best solution
+        std::uint32_t pass_{ 1 }; // number of the current pass
+        float weight_{ 1.0f }; // weight of the heuristic in the current pass
+        float proven_{ std::numeric_limits<float>::infinity() }; // weight of the last completed pass
+        std::chrono::steady_clock::time_point deadline_{}; // time when the search stops
+        std::size_t max_expanded_{ SIZE_MAX }; // number of expansions after which the search stops
+
+        SearchStats stats_{}; // counters of the search
+        SearchStats *timing_; // stats_ if phases are timed, nullptr otherwise
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+
+        std::size_t f(std::uint32_t index) const
         {
-            // Move in every possible direction
-            for (Direction direction : directions)
+            return nodes_[index].cost + heuristic_key(nodes_[index].distance);
+        }
+
+        void push(std::uint32_t index)
+        {
+            const auto &node = nodes_[index];
+            open_.push_back({ node.cost + weight_ * heuristic_key(node.distance), node.cost, index });
+            std::push_heap(open_.begin(), open_.end(), after);
+        }
+
+        // Recomputes keys with the new weight, nodes superseded by shorter paths are dropped
+        void rekey()
+        {
+            auto last = std::remove_if(open_.begin(), open_.end(),
+                [&](const Entry &entry) { return *closed_.find(nodes_[entry.index].key) != entry.index; });
+            open_.erase(last, open_.end());
+
+            for (auto &entry : open_)
+            {
+                entry.key = entry.cost + weight_ * heuristic_key(nodes_[entry.index].distance);
+            }
+
+            std::make_heap(open_.begin(), open_.end(), after);
+        }
+
+        bool is_exhausted()
+        {
+            if (stats_.expanded >= max_expanded_)
             {
-                temp = level_begin->move(direction);
+                return true;
+            }
 
-                // Check if moving in the given direction is possible
-                if (!temp.is_init())
+            return stats_.expanded % clock_period_ == 0 && std::chrono::steady_clock::now() >= deadline_;
+        }
+
+        // Runs one pass of weighted A*, returns false if the budget ran out before the pass was completed
+        bool improve()
+        {
+            while (!open_.empty())
+            {
+                stats_.peak_open = std::max(stats_.peak_open, open_.size() + incons_.size());
+
+                // Pass is over once no queued board can lead to a shorter solution
+                if (goal_ != no_parent && open_.front().key >= nodes_[goal_].cost)
+                {
+                    return true;
+                }
+
+                if (is_exhausted())
+                {
+                    return false;
+                }
+
+                // Unlike the budget, the control leaves no solution behind, as with every other search
+                if (is_stopped(control_, stats_.expanded,
+                    [&] { return SearchProgress{ stats_.expanded, stats_.generated, static_cast<std::size_t>(open_.front().key), stats().bytes }; }))
+                {
+                    goal_ = no_parent;
+                    return false;
+                }
+
+                std::pop_heap(open_.begin(), open_.end(), after);
+                const auto index = open_.back().index;
+                open_.pop_back();
+
+                // Skip the node if a shorter path to its board was found after it was queued
+                if (*closed_.find(nodes_[index].key) != index)
                 {
                     continue;
                 }
-                // Check for duplicates
-                else if (conditions.end() == std::find(conditions.begin(), conditions.end(), temp))
+
+                const auto node = nodes_[index];
+                const auto current = GameBoard<Rows, Cols>(node.key);
+                const auto blank = current.blank_cell();
+                stamps_[index] = pass_;
+                ++stats_.expanded;
+
+                for (Direction direction : directions)
                 {
-                    // Check if the result is reached
-                    if (temp == target)
+                    // Check if move is possible before the board is built
+                    if (!BoardGeometry<Rows, Cols>::can_move(blank, direction))
                     {
-                        return temp;
+                        continue;
                     }
 
-                    conditions.push_back(temp);
-                    ++current_level_board;
+                    auto temp = measure(timing_, &SearchStats::move_seconds, [&] { return current.move(direction); });
+                    ++stats_.generated;
+
+                    auto cost = static_cast<std::uint16_t>(node.cost + 1);
+                    auto[best, inserted] = measure(timing_, &SearchStats::dedup_seconds, [&] { return closed_.insert(temp.key(), 0); });
+
+                    if (!inserted && nodes_[*best].cost <= cost)
+                    {
+                        ++stats_.duplicates;
+                        continue;
+                    }
+
+                    // Board reached before keeps its distance, only the path changes
+                    const auto previous = inserted ? no_parent : *best;
+                    auto distance = 0.0f;
+
+                    if (inserted)
+                    {
+                        distance = measure(timing_, &SearchStats::heuristic_seconds,
+                            [&] { return heuristic_.update(node.distance, temp, blank); });
+                        ++stats_.evaluations;
+                    }
+                    else
+                    {
+                        distance = nodes_[previous].distance;
+                    }
+
+                    *best = nodes_.push({ temp.key(), index, direction, cost, distance });
+                    stamps_.push_back(0);
+
+                    // Goal is recorded when generated, it never has to be expanded
+                    if (temp == target_)
+                    {
+                        goal_ = *best;
+                    }
+                    else if (previous != no_parent && stamps_[previous] == pass_)
+                    {
+                        incons_.push_back(*best);
+                    }
+                    else
+                    {
+                        push(*best);
+                    }
                 }
             }
+
+            return true;
         }
+    };
 
-        previous_level_board = current_level_board;
-    }
-}
+    /**
+    * \brief Beam search
+    *
+    * \details Search goes level by level and keeps only the given number of boards closest to the target.
+    * Frontier and children live in buffers allocated once for the width, every board writes its children
+    * into its own slots, so slices of the frontier are expanded and scored by the thread pool without locks.
+    * Children are deduplicated within the level only, earlier levels keep nothing but the moves needed to trace the path.
+    */
+    template <std::size_t Rows, std::size_t Cols, typename Distance>
+    class BeamSearcher
+    {
+    public:
+        BeamSearcher() = delete;
 
-template <std::size_t Size>
-GameBoard<Size> depth_first_search(const GameBoard<Size> &initial, const GameBoard<Size> &target)
-{
-    DepthFirstSearcher<Size> depth_first_searcher(target);
+        BeamSearcher(GameBoard<Rows, Cols> target, std::size_t width, std::size_t threads, const PatternDatabase<Rows, Cols> *database = nullptr,
+            SearchControl *control = nullptr)
+            : seen_(std::max<std::size_t>(width, 1) * directions.size()), width_{ std::max<std::size_t>(width, 1) }, pool_(threads),
+            target_{ target }, heuristic_{ target, database }, control_{ control }
+        {
+            frontier_.reserve(width_);
+            next_.reserve(width_);
+            children_.resize(width_ * directions.size());
+            selected_.reserve(width_ * directions.size());
+        }
 
-    // Find solution
-    auto result = depth_first_searcher.find(initial);
+        /**
+        * \brief Runs the search until the target is reached or no board is left
+        *
+        * @return True if the target was reached, false otherwise or if the control stopped the search
+        */
+        bool find(const GameBoard<Rows, Cols> &initial, std::size_t max_depth)
+        {
+            frontier_.push_back({ initial.key(), heuristic_.evaluate(initial), {} });
+            history_.push_back({ { no_parent, {} } });
+            ++stats_.evaluations;
 
-    return result;
-}
+            if (initial == target_)
+            {
+                return true;
+            }
 
-template <std::size_t Size>
-GameBoard<Size> A_star(const GameBoard<Size> &initial, const GameBoard<Size> &target, DistanceType distance_type)
-{
-    AStarSearcher<Size> A_star_searcher(target, distance_type);
+            for (std::size_t depth = 0; depth < max_depth && !frontier_.empty(); depth++)
+            {
+                // Level is one batch of the pool, so the control is looked at once per level
+                if (is_stopped(control_, stats_.expanded, [&] { return SearchProgress{ stats_.expanded, stats_.generated, depth, stats().bytes }; }))
+                {
+                    return false;
+                }
 
-    // Find solution
-    auto result = A_star_searcher.find(initial);
+                expand(depth == 0);
+                stats_.expanded += frontier_.size();
+
+                if (select())
+                {
+                    return true;
+                }
+
+                stats_.peak_open = std::max(stats_.peak_open, frontier_.size());
+            }
+
+            return false;
+        }
+
+        std::vector<Direction> path() const
+        {
+            auto moves = std::vector<Direction>{};
+
+            // Target is the only board of the last level
+            std::uint32_t index = 0;
+
+            for (auto level = history_.size() - 1; level > 0; level--)
+            {
+                const auto &step = history_[level][index];
+                moves.push_back(step.move);
+                index = step.parent;
+            }
+
+            std::reverse(moves.begin(), moves.end());
+
+            return moves;
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return stats_.generated;
+        }
+
+        float distance(const GameBoard<Rows, Cols> &board) const noexcept
+        {
+            return heuristic_.evaluate(board);
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.bytes = seen_.memory() + (frontier_.capacity() + next_.capacity()) * sizeof(Beam)
+                + children_.capacity() * sizeof(Child) + selected_.capacity() * sizeof(std::uint32_t);
+
+            for (const auto &level : history_)
+            {
+                result.bytes += level.capacity() * sizeof(Step);
+            }
+
+            return result;
+        }
+
+    private:
+        using Key = typename GameBoard<Rows, Cols>::Key;
+
+        struct Beam
+        {
+            Key key; // packed board
+            float distance; // heuristic distance to the target
+            Direction move; // move which produced the board
+        };
+
+        struct Child
+        {
+            Key key; // packed board, empty if the move isn't possible
+            float distance; // heuristic distance to the target
+        };
+
+        struct Step
+        {
+            std::uint32_t parent; // index of the parent in the previous level
+            Direction move; // move which produced the board from its parent
+        };
+
+        static constexpr std::size_t min_slice_ = 256; // least number of boards expanded by one task
+
+        StateSet<Key> seen_; // children of the current level
+        std::size_t width_; // maximum number of boards in the frontier
+        ThreadPool pool_; // workers expanding slices of the frontier
+
+        std::vector<Beam> frontier_{}; // boards of the current level
+        std::vector<Beam> next_{}; // boards of the next level
+        std::vector<Child> children_{}; // child of every frontier board in every direction
+        std::vector<std::uint32_t> selected_{}; // slots of children kept in the next level
+        std::vector< std::vector<Step> > history_{}; // parent and move of every board of every level
+        GameBoard<Rows, Cols> target_{}; // target board
+
+        Distance heuristic_; // distance to the target board
+
+        SearchStats stats_{}; // counters of the search
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+
+        // Writes children of every frontier board into its slots, the move back to the parent is never made
+        void expand(bool is_root)
+        {
+            const auto slice = std::max(frontier_.size() / (pool_.size() * 4), min_slice_);
+
+            for (std::size_t begin = 0; begin < frontier_.size(); begin += slice)
+            {
+                pool_.submit([this, is_root, begin, end = std::min(frontier_.size(), begin + slice)]
+                {
+                    for (auto i = begin; i < end; i++)
+                    {
+                        const auto &parent = frontier_[i];
+                        const auto current = GameBoard<Rows, Cols>(parent.key);
+                        const auto blank = current.blank_cell();
+
+                        for (std::size_t d = 0; d < directions.size(); d++)
+                        {
+                            auto &child = children_[i * directions.size() + d];
+
+                            if (!BoardGeometry<Rows, Cols>::can_move(blank, directions[d]) || (!is_root && directions[d] == opposite(parent.move)))
+                            {
+                                child.key = Key{};
+                                continue;
+                            }
+
+                            const auto temp = current.move(directions[d]);
+                            child = { temp.key(), heuristic_.update(parent.distance, temp, blank) };
+                        }
+                    }
+                });
+            }
+
+            pool_.wait();
+        }
+
+        // Keeps the closest distinct children as the next level, returns true if one of them is the target
+        bool select()
+        {
+            const auto slots = frontier_.size() * directions.size();
+            bool is_found = false;
+
+            seen_.clear();
+            selected_.clear();
+
+            for (std::size_t slot = 0; slot < slots; slot++)
+            {
+                const auto &child = children_[slot];
+
+                if (child.key.empty())
+                {
+                    continue;
+                }
+
+                ++stats_.generated;
+                ++stats_.evaluations;
+
+                if (!seen_.insert(child.key))
+                {
+                    ++stats_.duplicates;
+                    continue;
+                }
+
+                // Target ends the search, it becomes the only board of the last level
+                if (child.key == target_.key())
+                {
+                    selected_.assign(1, static_cast<std::uint32_t>(slot));
+                    is_found = true;
+                    break;
+                }
+
+                selected_.push_back(static_cast<std::uint32_t>(slot));
+            }
+
+            stats_.peak_closed = std::max(stats_.peak_closed, seen_.size());
+
+            // Equal distances are ordered by slot, so the beam doesn't depend on the number of threads
+            auto closer = [this](std::uint32_t left, std::uint32_t right)
+            {
+                return children_[left].distance < children_[right].distance
+                    || (children_[left].distance == children_[right].distance && left < right);
+            };
+
+            if (selected_.size() > width_)
+            {
+                std::nth_element(selected_.begin(), selected_.begin() + width_, selected_.end(), closer);
+                selected_.resize(width_);
+            }
+
+            auto level = std::vector<Step>{};
+            level.reserve(selected_.size());
+            next_.clear();
+
+            for (auto slot : selected_)
+            {
+                const auto parent = static_cast<std::uint32_t>(slot / directions.size());
+                const auto move = directions[slot % directions.size()];
+
+                level.push_back({ parent, move });
+                next_.push_back({ children_[slot].key, children_[slot].distance, move });
+            }
+
+            history_.push_back(std::move(level));
+            frontier_.swap(next_);
+
+            return is_found;
+        }
+    };
+
+    template <std::size_t Rows, std::size_t Cols, typename Distance>
+    class IDAStarSearcher
+    {
+    public:
+        IDAStarSearcher() = delete;
+
+        IDAStarSearcher(GameBoard<Rows, Cols> target, const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr,
+            SearchControl *control = nullptr)
+            : target_{ target }, heuristic_{ target, database }, timing_{ stats != nullptr && stats->measure_phases ? &stats_ : nullptr }, control_{ control }
+        {}
+
+        bool find(const GameBoard<Rows, Cols> &initial)
+        {
+            board_ = initial;
+            path_.clear();
+
+            auto distance = measure(timing_, &SearchStats::heuristic_seconds, [&] { return heuristic_.evaluate(board_); });
+            ++stats_.evaluations;
+            auto bound = heuristic_key(distance);
+
+            // Deepen f-bound until the goal is reached or nothing is left beyond the bound
+            while (bound != not_found_)
+            {
+                auto next_bound = search(0, bound, distance);
+
+                if (next_bound == found_)
+                {
+                    return true;
+                }
+                else if (next_bound == stopped_)
+                {
+                    return false;
+                }
+
+                bound = next_bound;
+            }
+
+            return false;
+        }
+
+        const std::vector<Direction>& path() const noexcept
+        {
+            return path_;
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return nodes_;
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.bytes = path_.capacity() * sizeof(Direction);
+
+            return result;
+        }
+
+    private:
+        static constexpr std::size_t found_ = 0; ///< search result meaning that the goal is reached
+        static constexpr std::size_t not_found_ = SIZE_MAX; ///< search result meaning that nothing exceeded the bound
+        static constexpr std::size_t stopped_ = SIZE_MAX - 1; ///< search result meaning that the control stopped the search
+
+        GameBoard<Rows, Cols> board_{}; // the only board, which is changed in place
+        std::vector<Direction> path_{}; // moves from the initial board to the current one
+        GameBoard<Rows, Cols> target_{}; // target board
+        std::size_t nodes_{ 0 }; // number of visited nodes over all iterations
+
+        Distance heuristic_; // distance to the target board
+
+        SearchStats stats_{}; // counters of the search, open list is the current path
+        SearchStats *timing_; // stats_ if phases are timed, nullptr otherwise
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+
+        // Returns found_ if the goal is reached, stopped_ if the control stopped the search, otherwise the least f exceeding the bound
+        std::size_t search(std::size_t cost, std::size_t bound, float distance)
+        {
+            auto f = cost + heuristic_key(distance);
+            ++nodes_;
+
+            if (f > bound)
+            {
+                return f;
+            }
+            else if (board_ == target_)
+            {
+                return found_;
+            }
+
+            if (is_stopped(control_, stats_.expanded, [&] { return SearchProgress{ stats_.expanded, stats_.generated, bound, stats().bytes }; }))
+            {
+                return stopped_;
+            }
+
+            auto next_bound = not_found_;
+            auto previous_blank = board_.blank_cell();
+
+            ++stats_.expanded;
+            stats_.peak_open = std::max(stats_.peak_open, path_.size() + 1);
+
+            for (Direction direction : directions)
+            {
+                // Never undo the previous move
+                if (!path_.empty() && direction == opposite(path_.back()))
+                {
+                    ++stats_.duplicates;
+                    continue;
+                }
+                else if (!BoardGeometry<Rows, Cols>::can_move(previous_blank, direction))
+                {
+                    continue;
+                }
+
+                measure(timing_, &SearchStats::move_seconds, [&] { return board_.apply(direction); });
+                path_.push_back(direction);
+                ++stats_.generated;
+                ++stats_.evaluations;
+
+                auto child_distance = measure(timing_, &SearchStats::heuristic_seconds,
+                    [&] { return heuristic_.update(distance, board_, previous_blank); });
+                auto result = search(cost + 1, bound, child_distance);
+
+                // Path is left as it is, the search is over either way
+                if (result == found_ || result == stopped_)
+                {
+                    return result;
+                }
+
+                path_.pop_back();
+                board_.apply(opposite(direction));
+
+                next_bound = std::min(next_bound, result);
+            }
+
+            return next_bound;
+        }
+    };
+
+    /**
+    * \brief Hash distributed A*
+    *
+    * \details Every worker owns boards of its hash partition together with their open and closed lists.
+    * Children are sent to their owners in batches through lock-free queues.
+    * Search ends when no worker has nodes below the cost of the best solution found so far
+    * and no batch is on the way, both facts are tracked by a single counter of work.
+    */
+    template <std::size_t Rows, std::size_t Cols, typename Distance, typename TieBreaking = LargerCostFirst>
+    class HDAStarSearcher
+    {
+    public:
+        HDAStarSearcher() = delete;
+
+        HDAStarSearcher(GameBoard<Rows, Cols> target, std::size_t threads, const PatternDatabase<Rows, Cols> *database = nullptr,
+            SearchControl *control = nullptr)
+            : target_{ target }, control_{ control }
+        {
+            threads = std::max<std::size_t>(threads, 1);
+
+            for (std::size_t i = 0; i < threads; i++)
+            {
+                workers_.push_back(std::make_unique<Worker>(target, database, threads));
+            }
+        }
+
+        bool find(const GameBoard<Rows, Cols> &initial)
+        {
+            auto distance = workers_.front()->heuristic.evaluate(initial);
+            insert(*workers_[owner(initial.key())], { initial.key(), no_reference_, {}, 0, distance });
+
+            // Every worker is busy until it finds out it has nothing to do
+            work_ = workers_.size();
+
+            auto threads = std::vector<std::thread>{};
+
+            for (std::size_t i = 0; i < workers_.size(); i++)
+            {
+                threads.emplace_back([this, i] { run(i); });
+            }
+
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+
+            // Cancellation seen by any worker is recorded in the control once the workers are gone
+            if (is_interrupted_)
+            {
+                is_stopped(control_, 0, [] { return SearchProgress{}; });
+                return false;
+            }
+
+            return goal_ != no_reference_;
+        }
+
+        std::vector<Direction> path() const
+        {
+            auto moves = std::vector<Direction>{};
+
+            for (auto reference = goal_; reference != no_reference_; )
+            {
+                const auto &node = workers_[reference >> 32]->nodes[static_cast<std::uint32_t>(reference)];
+
+                if (node.parent == no_reference_)
+                {
+                    break;
+                }
+
+                moves.push_back(node.move);
+                reference = node.parent;
+            }
+
+            std::reverse(moves.begin(), moves.end());
+
+            return moves;
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            std::size_t result = 0;
+
+            for (const auto &worker : workers_)
+            {
+                result += worker->nodes.size();
+            }
+
+            return result;
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = SearchStats{};
+
+            for (const auto &worker : workers_)
+            {
+                result.generated += worker->stats.generated;
+                result.expanded += worker->stats.expanded;
+                result.duplicates += worker->stats.duplicates;
+                result.evaluations += worker->stats.evaluations;
+                result.peak_open += worker->stats.peak_open;
+                result.peak_closed += worker->closed.size();
+                result.bytes += worker->closed.memory() + worker->nodes.memory() + worker->open.memory();
+            }
+
+            return result;
+        }
+
+    private:
+        static constexpr std::uint64_t no_reference_ = UINT64_MAX; ///< parent of the root node
+        static constexpr std::size_t batch_size_ = 64; ///< children sent to another worker at once
+        static constexpr std::size_t expansions_ = 64; ///< nodes expanded between reads of the inbox
+
+        // Node of the search tree, parent is the index of the worker in the upper half and the node index in the lower one
+        struct Node
+        {
+            typename GameBoard<Rows, Cols>::Key key{};
+            std::uint64_t parent{ no_reference_ };
+            Direction move{};
+            std::uint16_t cost{ 0 };
+            float distance{ 0.0f };
+        };
+
+        using Batch = std::vector<Node>;
+
+        struct alignas(64) Worker
+        {
+            Worker(const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> *database, std::size_t threads)
+                : outboxes(threads), heuristic{ target, database }
+            {}
+
+            StateMap<typename GameBoard<Rows, Cols>::Key, std::uint32_t> closed{}; // index of the best node of every owned board
+            NodeArena<Node> nodes{}; // owned part of the search tree
+            BucketQueue<TieBreaking> open{}; // owned frontier ordered by f = g + h
+            MpscQueue<Batch> inbox{}; // children sent by other workers
+            std::vector<Batch> outboxes{}; // children waiting to be sent to every worker
+            Distance heuristic; // distance to the target board
+            SearchStats stats{}; // counters of the worker, phases aren't timed
+            bool is_busy{ true }; // true while the worker is counted in work_
+            std::atomic<std::size_t> expanded{ 0 }; // expansions published for the progress of the search
+            std::atomic<std::size_t> generated{ 0 }; // generated boards published for the progress of the search
+            std::atomic<std::size_t> bytes{ 0 }; // memory of the worker published for the progress of the search
+        };
+
+        GameBoard<Rows, Cols> target_{}; // target board
+        std::vector< std::unique_ptr<Worker> > workers_{}; // owners of the hash partitions
+
+        std::atomic<std::size_t> work_{ 0 }; // batches on the way plus busy workers
+        std::atomic<std::size_t> incumbent_{ SIZE_MAX }; // cost of the best solution found so far
+        std::atomic<bool> is_done_{ false }; // set once work_ drops to zero or the control stops the search
+        std::atomic<bool> is_interrupted_{ false }; // set if the control stopped the search
+        SearchControl *control_; // cancellation and progress of the search, may be nullptr
+
+        std::mutex goal_mutex_{}; // guards goal_ together with updates of incumbent_
+        std::uint64_t goal_{ no_reference_ }; // node of the best solution found so far
+
+        std::size_t owner(const typename GameBoard<Rows, Cols>::Key &key) const noexcept
+        {
+            // Upper bits of the hash, lower ones pick the slot of the closed list
+            return static_cast<std::size_t>((static_cast<std::uint64_t>(key.hash()) * 0x9E3779B97F4A7C15ull) >> 32) % workers_.size();
+        }
+
+        bool has_work(Worker &worker) const
+        {
+            return !worker.open.empty() && worker.open.min_key() < incumbent_.load(std::memory_order_acquire);
+        }
+
+        void insert(Worker &worker, const Node &node)
+        {
+            auto f = node.cost + heuristic_key(node.distance);
+
+            if (f >= incumbent_.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            auto[best, inserted] = worker.closed.insert(node.key, 0);
+
+            // Reopen the board only if the new path is shorter
+            if (!inserted && worker.nodes[*best].cost <= node.cost)
+            {
+                ++worker.stats.duplicates;
+                return;
+            }
+
+            *best = worker.nodes.push(node);
+            worker.open.push(f, node.cost, *best);
+            worker.stats.peak_open = std::max(worker.stats.peak_open, worker.open.size());
+        }
+
+        void send(std::size_t receiver, Batch &batch)
+        {
+            work_.fetch_add(1, std::memory_order_acq_rel);
+            workers_[receiver]->inbox.push(std::move(batch));
+
+            batch = Batch{};
+            batch.reserve(batch_size_);
+        }
+
+        void expand(Worker &worker, std::size_t self)
+        {
+            auto index = worker.open.pop();
+            const auto node = worker.nodes[index];
+
+            // Skip the node if a shorter path to its board was found after it was queued
+            if (*worker.closed.find(node.key) != index)
+            {
+                return;
+            }
+
+            const auto current = GameBoard<Rows, Cols>(node.key);
+            const auto blank = current.blank_cell();
+            const auto reference = (static_cast<std::uint64_t>(self) << 32) | index;
+
+            // Goal can't be expanded further, cheaper solutions may still be found by other workers
+            if (current == target_)
+            {
+                std::lock_guard<std::mutex> lock(goal_mutex_);
+
+                if (node.cost < incumbent_.load(std::memory_order_acquire))
+                {
+                    incumbent_.store(node.cost, std::memory_order_release);
+                    goal_ = reference;
+                }
+
+                return;
+            }
+
+            ++worker.stats.expanded;
+
+            for (Direction direction : directions)
+            {
+                // Never undo the previous move, check if move is possible before the board is built
+                if ((node.parent != no_reference_ && direction == opposite(node.move)) || !BoardGeometry<Rows, Cols>::can_move(blank, direction))
+                {
+                    continue;
+                }
+
+                auto temp = current.move(direction);
+
+                ++worker.stats.generated;
+                ++worker.stats.evaluations;
+
+                auto distance = worker.heuristic.update(node.distance, temp, blank);
+                auto child = Node{ temp.key(), reference, direction, static_cast<std::uint16_t>(node.cost + 1), distance };
+                auto receiver = owner(child.key);
+
+                if (receiver == self)
+                {
+                    insert(worker, child);
+                    continue;
+                }
+
+                auto &outbox = worker.outboxes[receiver];
+                outbox.push_back(child);
+
+                if (outbox.size() >= batch_size_)
+                {
+                    send(receiver, outbox);
+                }
+            }
+        }
+
+        // Publishes counters of the worker, every worker watches the token, the first one reports progress and watches the memory cap
+        bool is_stopped_by_control(Worker &worker, std::size_t self)
+        {
+            worker.expanded.store(worker.stats.expanded, std::memory_order_relaxed);
+            worker.generated.store(worker.stats.generated, std::memory_order_relaxed);
+            worker.bytes.store(worker.closed.memory() + worker.nodes.memory() + worker.open.memory(), std::memory_order_relaxed);
+
+            if (self != 0)
+            {
+                return control_->is_cancelled();
+            }
+
+            std::size_t expanded = 0;
+
+            for (const auto &other : workers_)
+            {
+                expanded += other->expanded.load(std::memory_order_relaxed);
+            }
+
+            return control_->is_stopped(expanded, [&]
+            {
+                auto progress = SearchProgress{ expanded, 0, worker.open.empty() ? 0 : worker.open.min_key(), 0 };
+
+                for (const auto &other : workers_)
+                {
+                    progress.generated += other->generated.load(std::memory_order_relaxed);
+                    progress.bytes += other->bytes.load(std::memory_order_relaxed);
+                }
+
+                return progress;
+            });
+        }
+
+        void run(std::size_t self)
+        {
+            auto &worker = *workers_[self];
+            auto batch = Batch{};
+
+            while (!is_done_.load(std::memory_order_acquire))
+            {
+                // Workers leave together, whatever they still hold is dropped
+                if (control_ != nullptr && is_stopped_by_control(worker, self))
+                {
+                    is_interrupted_.store(true, std::memory_order_relaxed);
+                    is_done_.store(true, std::memory_order_release);
+                    break;
+                }
+
+                while (worker.inbox.pop(batch))
+                {
+                    // Count the worker as busy before the batch stops being counted
+                    if (!worker.is_busy)
+                    {
+                        worker.is_busy = true;
+                        work_.fetch_add(1, std::memory_order_acq_rel);
+                    }
+
+                    for (const Node &node : batch)
+                    {
+                        insert(worker, node);
+                    }
+
+                    work_.fetch_sub(1, std::memory_order_acq_rel);
+                }
+
+                for (std::size_t i = 0; i < expansions_ && has_work(worker); i++)
+                {
+                    expand(worker, self);
+                }
+
+                for (std::size_t receiver = 0; receiver < workers_.size(); receiver++)
+                {
+                    if (!worker.outboxes[receiver].empty())
+                    {
+                        send(receiver, worker.outboxes[receiver]);
+                    }
+                }
+
+                if (has_work(worker))
+                {
+                    continue;
+                }
+
+                if (worker.is_busy)
+                {
+                    worker.is_busy = false;
+
+                    if (work_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        is_done_.store(true, std::memory_order_release);
+                    }
+                }
+                else if (work_.load(std::memory_order_acquire) == 0)
+                {
+                    is_done_.store(true, std::memory_order_release);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    };
+
+    template <std::size_t Rows, std::size_t Cols>
+    class BidirectionalSearcher
+    {
+    public:
+        BidirectionalSearcher() = delete;
+
+        BidirectionalSearcher(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, SearchStats *stats = nullptr,
+            SearchControl *control = nullptr)
+            : timing_{ stats != nullptr && stats->measure_phases ? &stats_ : nullptr }, control_{ control }
+        {
+            forward_.nodes.push({ initial.key() });
+            forward_.visited.insert(initial.key(), 0);
+
+            backward_.nodes.push({ target.key() });
+            backward_.visited.insert(target.key(), 0);
+        }
+
+        bool find()
+        {
+            // Boards are equal
+            if (forward_.nodes[0].key == backward_.nodes[0].key)
+            {
+                return true;
+            }
+
+            // Sum of the depths of both trees
+            std::size_t depth = 0;
+
+            while (forward_.level_size() > 0 && backward_.level_size() > 0)
+            {
+                if (is_stopped(control_, stats_.expanded, [&] { return SearchProgress{ stats_.expanded, stats_.generated, depth, stats().bytes }; }))
+                {
+                    return false;
+                }
+
+                ++depth;
+
+                // Always grow the smaller frontier
+                if (forward_.level_size() <= backward_.level_size())
+                {
+                    expand(forward_, backward_, false);
+                }
+                else
+                {
+                    expand(backward_, forward_, true);
+                }
+
+                if (!path_.empty())
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        const std::vector<Direction>& path() const noexcept
+        {
+            return path_;
+        }
+
+        std::size_t nodes() const noexcept
+        {
+            return forward_.nodes.size() + backward_.nodes.size();
+        }
+
+        SearchStats stats() const noexcept
+        {
+            auto result = stats_;
+            result.peak_closed = forward_.visited.size() + backward_.visited.size();
+            result.bytes = forward_.visited.memory() + forward_.nodes.memory() + backward_.visited.memory() + backward_.nodes.memory();
+
+            return result;
+        }
+
+    private:
+        struct Frontier
+        {
+            NodeArena< SearchNode<Rows, Cols> > nodes{}; // search tree, boards are stored level by level
+            StateMap<typename GameBoard<Rows, Cols>::Key, std::uint32_t> visited{}; // index of every board in the tree
+            std::uint32_t level_begin{ 0 }; // index of the first board of the last level
+
+            std::size_t level_size() const noexcept
+            {
+                return nodes.size() - level_begin;
+            }
+        };
+
+        Frontier forward_{}; // tree grown from the initial board
+        Frontier backward_{}; // tree grown from the target board
+        std::vector<Direction> path_{}; // moves from the initial board to the target
+
+        SearchStats stats_{}; // counters of the search
+        SearchStats *timing_{ nullptr }; // stats_ if phases are timed, nullptr otherwise
+        SearchControl *control_{ nullptr }; // cancellation and progress of the search, may be nullptr, looked at once per level
+
+        // Expands the last level of one tree and remembers the shortest path through boards of the other tree
+        void expand(Frontier &frontier, const Frontier &other, bool is_backward)
+        {
+            const auto level_end = static_cast<std::uint32_t>(frontier.nodes.size());
+            auto best_length = SIZE_MAX;
+
+            stats_.peak_open = std::max(stats_.peak_open, forward_.level_size() + backward_.level_size());
+
+            for (auto i = frontier.level_begin; i < level_end; ++i)
+            {
+                const auto current = GameBoard<Rows, Cols>(frontier.nodes[i].key);
+
+                ++stats_.expanded;
+
+                for (Direction direction : directions)
+                {
+                    auto temp = measure(timing_, &SearchStats::move_seconds, [&] { return current.move(direction); });
+
+                    // Check if move is possible
+                    if (!temp.is_init())
+                    {
+                        continue;
+                    }
+
+                    ++stats_.generated;
+
+                    auto[index, inserted] = measure(timing_, &SearchStats::dedup_seconds, [&] { return frontier.visited.insert(temp.key(), 0); });
+
+                    if (!inserted)
+                    {
+                        ++stats_.duplicates;
+                        continue;
+                    }
+
+                    *index = frontier.nodes.push({ temp.key(), i, direction });
+
+                    // Check if the trees met
+                    if (const auto *meeting = measure(timing_, &SearchStats::dedup_seconds, [&] { return other.visited.find(temp.key()); }))
+                    {
+                        auto own = trace_moves(frontier.nodes, *index);
+                        auto rest = trace_moves(other.nodes, *meeting);
+
+                        if (own.size() + rest.size() < best_length)
+                        {
+                            best_length = own.size() + rest.size();
+                            path_ = is_backward ? join(rest, own) : join(own, rest);
+                        }
+                    }
+                }
+            }
+
+            frontier.level_begin = level_end;
+        }
+
+        // Joins moves from the initial board with moves from the target board to the same board
+        static std::vector<Direction> join(std::vector<Direction> forward, const std::vector<Direction> &backward)
+        {
+            for (auto iter = backward.crbegin(); iter != backward.crend(); ++iter)
+            {
+                forward.push_back(opposite(*iter));
+            }
+
+            return forward;
+        }
+    };
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> breadth_first_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    auto nodes = NodeArena< SearchNode<Rows, Cols> >{}; // search tree, boards are stored level by level
+    auto visited = VisitedBoards<Rows, Cols>(target); // all boards in the tree
+    auto previous_level_board = 1; // number of boards added on previous level
+    auto current_level_board = 0; // number of boards on current level
+
+    std::uint32_t level_begin = 0; // index of the first board of the previous level
+    std::size_t depth = 0; // number of moves to the boards of the previous level
+
+    auto temp = GameBoard<Rows, Cols>{};
+    auto counters = SearchStats{}; // counters of the search
+    auto *timing = (stats != nullptr && stats->measure_phases) ? &counters : nullptr; // counters if phases are timed
+
+    SearchTimer timer(stats);
+
+    // Fills statistics once the search is over
+    auto report = [&]
+    {
+        if (stats != nullptr)
+        {
+            *stats = counters;
+            stats->peak_closed = nodes.size();
+            stats->bytes = nodes.memory() + visited.memory();
+        }
+    };
+
+    if (initial == target)
+    {
+        return { initial, {} };
+    }
+
+    // Half of the boards can't reach the target, there is no need to search through the other half
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    nodes.push({ initial.key() });
+    visited.insert(initial);
+
+    while (previous_level_board > 0)
+    {
+        counters.peak_open = std::max(counters.peak_open, static_cast<std::size_t>(previous_level_board));
+
+        // Get childs from every board on the previous level
+        for (std::uint32_t i = level_begin; i < level_begin + previous_level_board; ++i)
+        {
+            const auto current = GameBoard<Rows, Cols>(nodes[i].key);
+
+            if (is_stopped(control, counters.expanded,
+                [&] { return SearchProgress{ counters.expanded, counters.generated, depth, nodes.memory() + visited.memory() }; }))
+            {
+                report();
+                return {};
+            }
+
+            ++counters.expanded;
+
+            // Move in every possible direction
+            for (Direction direction : directions)
+            {
+                temp = measure(timing, &SearchStats::move_seconds, [&] { return current.move(direction); });
+
+                // Check if moving in the given direction is possible
+                if (!temp.is_init())
+                {
+                    continue;
+                }
+
+                ++counters.generated;
+
+                // Check for duplicates
+                if (measure(timing, &SearchStats::dedup_seconds, [&] { return visited.insert(temp); }))
+                {
+                    auto index = nodes.push({ temp.key(), i, direction });
+
+                    // Check if the result is reached
+                    if (temp == target)
+                    {
+                        report();
+                        return { initial, trace_moves(nodes, index), nodes.size() };
+                    }
+
+                    ++current_level_board;
+                }
+                else
+                {
+                    ++counters.duplicates;
+                }
+            }
+        }
+
+        level_begin += previous_level_board;
+        previous_level_board = current_level_board;
+        current_level_board = 0;
+        ++depth;
+    }
+
+    // Every reachable board was checked
+    report();
+    return {};
+}
+
+/**
+* \brief Breadth first search on several threads
+*
+* \details Levels are expanded one by one. Every level is cut into slices, which are expanded
+* by the thread pool into separate buffers, boards are deduplicated through the shared visited set.
+* Buffers are joined in the order of slices once the whole level is done, so the tree doesn't depend on scheduling.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param threads number of threads
+* @param stats statistics of the search or nullptr
+* @param control cancellation, progress and memory cap of the search or nullptr, looked at once per level
+*
+* @return Shortest solution, not found solution if the target can't be reached or the control stopped the search
+*/
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> parallel_breadth_first_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target,
+    std::size_t threads = std::thread::hardware_concurrency(), SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    using Level = std::vector< SearchNode<Rows, Cols> >; // boards of one level, parent is the index in the previous level
+
+    SearchTimer timer(stats);
+
+    if (initial == target)
+    {
+        return { initial, {} };
+    }
+    else if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    auto levels = std::vector<Level>{};
+    auto visited = ConcurrentVisitedBoards<Rows, Cols>(target);
+    auto is_found = std::atomic<bool>{ false };
+    auto generated = std::atomic<std::size_t>{ 0 };
+    auto expanded = std::atomic<std::size_t>{ 0 };
+    std::size_t nodes = 1;
+    std::size_t bytes = 0;
+    std::size_t peak_open = 1;
+
+    ThreadPool pool(threads);
+
+    levels.push_back({ { initial.key() } });
+    visited.insert(initial);
+
+    while (!levels.back().empty())
+    {
+        const auto &level = levels.back();
+
+        // Enough slices to keep every thread busy, each one large enough to outweigh the cost of the task
+        const auto slice = std::max<std::size_t>(level.size() / (pool.size() * 4), 256);
+        auto buffers = std::vector<Level>((level.size() + slice - 1) / slice);
+
+        for (std::size_t k = 0; k < buffers.size(); k++)
+        {
+            pool.submit([&, k]
+            {
+                auto &buffer = buffers[k];
+                const auto end = std::min(level.size(), (k + 1) * slice);
+                std::size_t slice_generated = 0;
+                std::size_t slice_expanded = 0;
+
+                for (auto i = k * slice; i < end && !is_found.load(std::memory_order_relaxed); i++)
+                {
+                    // Cancelled level is cut short, the check after the level stops the search
+                    if (control != nullptr && control->is_cancelled())
+                    {
+                        break;
+                    }
+
+                    const auto current = GameBoard<Rows, Cols>(level[i].key);
+
+                    ++slice_expanded;
+
+                    for (Direction direction : directions)
+                    {
+                        auto temp = current.move(direction);
+
+                        // Check if moving in the given direction is possible
+                        if (!temp.is_init())
+                        {
+                            continue;
+                        }
+
+                        ++slice_generated;
+
+                        // Check for duplicates
+                        if (visited.insert(temp))
+                        {
+                            buffer.push_back({ temp.key(), static_cast<std::uint32_t>(i), direction });
+
+                            if (temp == target)
+                            {
+                                is_found.store(true, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+
+                generated.fetch_add(slice_generated, std::memory_order_relaxed);
+                expanded.fetch_add(slice_expanded, std::memory_order_relaxed);
+            });
+        }
+
+        pool.wait();
+
+        auto next = Level{};
+
+        for (const Level &buffer : buffers)
+        {
+            next.insert(next.end(), buffer.begin(), buffer.end());
+        }
+
+        nodes += next.size();
+        bytes += next.capacity() * sizeof(SearchNode<Rows, Cols>);
+        peak_open = std::max(peak_open, next.size());
+        levels.push_back(std::move(next));
+
+        if (is_found)
+        {
+            break;
+        }
+
+        // Last level doesn't hold the target, so the lookup below returns not found solution
+        if (is_stopped(control, expanded,
+            [&] { return SearchProgress{ expanded, generated, levels.size() - 1, bytes + visited.memory() }; }))
+        {
+            break;
+        }
+    }
+
+    if (stats != nullptr)
+    {
+        stats->generated = generated;
+        stats->expanded = expanded;
+        stats->duplicates = generated - (nodes - 1);
+        stats->peak_open = peak_open;
+        stats->peak_closed = nodes;
+        stats->bytes = bytes + visited.memory();
+    }
+
+    const auto &last = levels.back();
+    auto goal = std::find_if(last.begin(), last.end(), [&target](const SearchNode<Rows, Cols> &node) { return node.key == target.key(); });
+
+    // Every reachable board was checked
+    if (goal == last.end())
+    {
+        return {};
+    }
+
+    auto moves = std::vector<Direction>{};
+    auto index = static_cast<std::uint32_t>(goal - last.begin());
+
+    for (auto level = levels.size() - 1; level > 0; level--)
+    {
+        moves.push_back(levels[level][index].move);
+        index = levels[level][index].parent;
+    }
+
+    std::reverse(moves.begin(), moves.end());
+
+    return { initial, std::move(moves), nodes };
+}
+
+/**
+* \brief Breadth first search with levels kept on disk
+*
+* \details Levels are counted from the target and left in the directory,
+* so later boards with the same target reuse them and an interrupted search resumes where it stopped.
+* Memory holds only the successors which are being sorted, see ExternalBreadthFirstSearch.
+* Directory can't be shared by searches running at the same time.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param directory directory of the level files
+* @param memory bytes of successors sorted in memory
+* @param stats statistics of the search or nullptr
+* @param control cancellation, progress and memory cap of the search or nullptr, looked at once per level
+*
+* @return Shortest solution, not found solution if the target can't be reached, the directory isn't usable
+* or the control stopped the search
+*/
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> external_breadth_first_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const std::string &directory,
+    std::size_t memory = ExternalBreadthFirstSearch<Rows, Cols>::default_memory, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (initial == target)
+    {
+        return { initial, {} };
+    }
+    else if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    auto search = ExternalBreadthFirstSearch<Rows, Cols>(target, directory, memory);
+    auto solution = search.solve(initial, control);
+
+    if (stats != nullptr)
+    {
+        *stats = search.stats();
+    }
+
+    return solution;
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> bidirectional_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    BidirectionalSearcher<Rows, Cols> bidirectional_searcher(initial, target, stats, control);
+
+    // Find solution
+    auto is_found = bidirectional_searcher.find();
+
+    if (stats != nullptr)
+    {
+        *stats = bidirectional_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    return { initial, bidirectional_searcher.path(), bidirectional_searcher.nodes() };
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> depth_first_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target,
+    std::size_t max_depth = unlimited_depth, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    DepthFirstSearcher<Rows, Cols> depth_first_searcher(target, stats, control);
+
+    // Find solution
+    auto is_found = depth_first_searcher.find(initial, max_depth);
+
+    if (stats != nullptr)
+    {
+        *stats = depth_first_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    // Path of the first branch which reached the target is usually far from the shortest one
+    auto solution = Solution<Rows, Cols>{ initial, depth_first_searcher.path(), depth_first_searcher.nodes() };
+    solution.set_bound(length_bound(solution.length(), ManhattanDistance<Rows, Cols>(target).evaluate(initial)));
+
+    return solution;
+}
+
+/**
+* \brief Iterative deepening depth first search
+*
+* \details Searches the tree to depth 0, 1, 2 and so on, so the first path found is the shortest one.
+* Memory is proportional to the depth, the price is repeated expansion of shallow boards.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param max_depth the longest path to look for
+* @param stats statistics of the search or nullptr
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Shortest solution, not found solution if there is no path within max_depth
+*/
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> iterative_deepening_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target,
+    std::size_t max_depth = unlimited_depth, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    DepthFirstSearcher<Rows, Cols> depth_first_searcher(target, stats, control);
+
+    // Find solution
+    auto is_found = depth_first_searcher.find_shortest(initial, max_depth);
+
+    if (stats != nullptr)
+    {
+        *stats = depth_first_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    return { initial, depth_first_searcher.path(), depth_first_searcher.nodes() };
+}
+
+/**
+* \brief A* search with the heuristic and the tie-breaking chosen at compile time
+*
+* \details Searcher is instantiated for the policies, so the heuristic is inlined into the expansion loop
+*
+* @tparam Distance heuristic policy, for example ManhattanDistance<Rows, Cols> or PatternDatabaseDistance<Rows, Cols>
+* @tparam TieBreaking order of nodes with equal f, LargerCostFirst or SmallerCostFirst
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param database pattern databases of PatternDatabaseDistance, ignored by other policies
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Shortest solution, not found solution if the target can't be reached or the control stopped the search
+*/
+template <typename Distance, typename TieBreaking = LargerCostFirst, std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> *database = nullptr,
+    SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    AStarSearcher<Rows, Cols, Distance, TieBreaking> A_star_searcher(target, database, stats, control);
+
+    // Find solution
+    auto result = A_star_searcher.find(initial);
+
+    if (stats != nullptr)
+    {
+        *stats = A_star_searcher.stats();
+    }
+
+    if (result == no_parent)
+    {
+        return {};
+    }
+
+    return { initial, A_star_searcher.path(result), A_star_searcher.nodes() };
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, DistanceType distance_type, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    const PatternDatabase<Rows, Cols> *no_database = nullptr;
+
+    return visit_distance<Rows, Cols>(distance_type, [&](auto tag)
+    {
+        return A_star<typename decltype(tag)::type>(initial, target, no_database, stats, control);
+    });
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> &database, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    return A_star< PatternDatabaseDistance<Rows, Cols> >(initial, target, &database, stats, control);
+}
+
+/**
+* \brief Anytime weighted A* with the heuristic chosen at compile time
+*
+* \details The first solution is found by A* with the heuristic multiplied by the weight,
+* then the weight is decreased and the search goes on from the same tree until the solution is proven shortest
+* or the budget runs out. Solution holds the bound of the ratio between its length and the shortest one.
+*
+* @tparam Distance heuristic policy, for example ManhattanDistance<Rows, Cols> or PatternDatabaseDistance<Rows, Cols>
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param budget time and number of expansions after which the best solution found so far is returned
+* @param weight weight of the heuristic in the first pass, values below 1 are raised to 1
+* @param database pattern databases of PatternDatabaseDistance, ignored by other policies
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Best solution found within the budget, not found solution if the budget ran out before the target was reached
+* or the control stopped the search
+*/
+template <typename Distance, std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> anytime_A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const SearchBudget &budget,
+    float weight = 3.0f, const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    AnytimeSearcher<Rows, Cols, Distance> anytime_searcher(target, database, stats, control);
+
+    // Find solution
+    auto result = anytime_searcher.find(initial, budget, weight);
+
+    if (stats != nullptr)
+    {
+        *stats = anytime_searcher.stats();
+    }
+
+    if (result == no_parent)
+    {
+        return {};
+    }
+
+    auto solution = Solution<Rows, Cols>{ initial, anytime_searcher.path(result), anytime_searcher.nodes() };
+    solution.set_bound(anytime_searcher.bound());
+
+    return solution;
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> anytime_A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, DistanceType distance_type,
+    const SearchBudget &budget, float weight = 3.0f, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    const PatternDatabase<Rows, Cols> *no_database = nullptr;
+
+    return visit_distance<Rows, Cols>(distance_type, [&](auto tag)
+    {
+        return anytime_A_star<typename decltype(tag)::type>(initial, target, budget, weight, no_database, stats, control);
+    });
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> anytime_A_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> &database,
+    const SearchBudget &budget, float weight = 3.0f, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    return anytime_A_star< PatternDatabaseDistance<Rows, Cols> >(initial, target, budget, weight, &database, stats, control);
+}
+
+/**
+* \brief Beam search with the heuristic chosen at compile time
+*
+* \details Every level keeps at most width boards with the least distance to the target,
+* so memory of the frontier doesn't grow with the depth. Parent and move of every kept board stay until the end
+* to trace the moves back, so the search takes O(width * depth) memory of 8 bytes per board besides the frontier;
+* max_depth or the memory cap of the control bounds it. Wider beam finds shorter solutions and takes longer,
+* no width guarantees that a solution is found or that it is the shortest one.
+*
+* @tparam Distance heuristic policy, for example LinearConflictDistance<Rows, Cols> or PatternDatabaseDistance<Rows, Cols>
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param width maximum number of boards kept in every level
+* @param threads number of threads expanding and scoring the frontier
+* @param max_depth number of levels after which the search gives up
+* @param database pattern databases of PatternDatabaseDistance, ignored by other policies
+* @param control cancellation, progress and memory cap of the search or nullptr, looked at once per level
+*
+* @return Solution with the ratio of its length to the distance of the initial board as the bound,
+* not found solution if the beam died out, max_depth was reached or the control stopped the search
+*/
+template <typename Distance, std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> beam_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, std::size_t width,
+    std::size_t threads = std::thread::hardware_concurrency(), std::size_t max_depth = beam_depth_limit,
+    const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    BeamSearcher<Rows, Cols, Distance> beam_searcher(target, width, threads, database, control);
+
+    // Find solution
+    auto is_found = beam_searcher.find(initial, max_depth);
+
+    if (stats != nullptr)
+    {
+        *stats = beam_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    // Beam doesn't prove the path shortest, only the heuristic bounds the shortest one
+    auto solution = Solution<Rows, Cols>{ initial, beam_searcher.path(), beam_searcher.nodes() };
+    solution.set_bound(length_bound(solution.length(), beam_searcher.distance(initial)));
+
+    return solution;
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> beam_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, DistanceType distance_type,
+    std::size_t width, std::size_t threads = std::thread::hardware_concurrency(), std::size_t max_depth = beam_depth_limit, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    const PatternDatabase<Rows, Cols> *no_database = nullptr;
+
+    return visit_distance<Rows, Cols>(distance_type, [&](auto tag)
+    {
+        return beam_search<typename decltype(tag)::type>(initial, target, width, threads, max_depth, no_database, stats, control);
+    });
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> beam_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> &database,
+    std::size_t width, std::size_t threads = std::thread::hardware_concurrency(), std::size_t max_depth = beam_depth_limit, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    return beam_search< PatternDatabaseDistance<Rows, Cols> >(initial, target, width, threads, max_depth, &database, stats, control);
+}
+
+/**
+* \brief Iterative deepening A* with the heuristic chosen at compile time
+*
+* @tparam Distance heuristic policy
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param database pattern databases of PatternDatabaseDistance, ignored by other policies
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Shortest solution, not found solution if the target can't be reached or the control stopped the search
+*/
+template <typename Distance, std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> IDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> *database = nullptr,
+    SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    IDAStarSearcher<Rows, Cols, Distance> IDA_star_searcher(target, database, stats, control);
+
+    // Find solution
+    auto is_found = IDA_star_searcher.find(initial);
+
+    if (stats != nullptr)
+    {
+        *stats = IDA_star_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    return { initial, IDA_star_searcher.path(), IDA_star_searcher.nodes() };
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> IDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, DistanceType distance_type, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    const PatternDatabase<Rows, Cols> *no_database = nullptr;
+
+    return visit_distance<Rows, Cols>(distance_type, [&](auto tag)
+    {
+        return IDA_star<typename decltype(tag)::type>(initial, target, no_database, stats, control);
+    });
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> IDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> &database, SearchStats *stats = nullptr,
+    SearchControl *control = nullptr)
+{
+    return IDA_star< PatternDatabaseDistance<Rows, Cols> >(initial, target, &database, stats, control);
+}
+
+/**
+* \brief Hash distributed A* with the heuristic and the tie-breaking chosen at compile time
+*
+* @tparam Distance heuristic policy
+* @tparam TieBreaking order of nodes with equal f within every worker
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+* @param threads number of workers
+* @param database pattern databases of PatternDatabaseDistance, ignored by other policies
+* @param control cancellation, progress and memory cap of the search or nullptr, looked at by every worker once per round of expansions
+*
+* @return Shortest solution, not found solution if the target can't be reached or the control stopped the search
+*/
+template <typename Distance, typename TieBreaking = LargerCostFirst, std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> HDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, std::size_t threads = std::thread::hardware_concurrency(),
+    const PatternDatabase<Rows, Cols> *database = nullptr, SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    SearchTimer timer(stats);
+
+    if (!is_solvable(initial, target))
+    {
+        return {};
+    }
+
+    HDAStarSearcher<Rows, Cols, Distance, TieBreaking> HDA_star_searcher(target, threads, database, control);
+
+    // Find solution
+    auto is_found = HDA_star_searcher.find(initial);
+
+    if (stats != nullptr)
+    {
+        *stats = HDA_star_searcher.stats();
+    }
+
+    if (!is_found)
+    {
+        return {};
+    }
+
+    return { initial, HDA_star_searcher.path(), HDA_star_searcher.nodes() };
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> HDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, DistanceType distance_type,
+    std::size_t threads = std::thread::hardware_concurrency(), SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    const PatternDatabase<Rows, Cols> *no_database = nullptr;
+
+    return visit_distance<Rows, Cols>(distance_type, [&](auto tag)
+    {
+        return HDA_star<typename decltype(tag)::type>(initial, target, threads, no_database, stats, control);
+    });
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> HDA_star(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> &database,
+    std::size_t threads = std::thread::hardware_concurrency(), SearchStats *stats = nullptr, SearchControl *control = nullptr)
+{
+    return HDA_star< PatternDatabaseDistance<Rows, Cols> >(initial, target, threads, &database, stats, control);
+}
+
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> oracle_search(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const MoveOracle<Rows, Cols> &oracle,
+    SearchStats *stats = nullptr)
+{
+    SearchTimer timer(stats);
+
+    // Table answers only for the target it was built for
+    if (!oracle.matches(target))
+    {
+        return {};
+    }
+
+    auto solution = oracle.solve(initial);
+
+    // Every lookup of the table stands for a heuristic evaluation
+    if (stats != nullptr)
+    {
+        stats->expanded = solution.length();
+        stats->evaluations = solution.nodes();
+    }
 
-    return result;
+    return solution;
 }
 
 #endif // EIGHT_PUZZLE_SOLVER_
@@ -0,0 +1,876 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef EXTERNAL_SEARCH_H_
+#define EXTERNAL_SEARCH_H_
+
+#include "game_board.h"
+#include "solution.h"
+#include "search_control.h"
+#include "search_stats.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <memory>
+#include <filesystem>
+#include <system_error>
+
+/**
+* \brief Layout of sorted files of packed boards
+*
+* \details Keys are written big-endian word by word, so the byte order of records is the order of keys.
+* Record holds the number of leading bytes shared with the previous key followed by the rest of the key,
+* neighbouring boards of a sorted level share most of their leading bytes.
+*
+* File layout (native byte order): "NRUN", version, bytes per key, number of keys, then records.
+*
+* @tparam Key packed board encoding
+*/
+template <typename Key>
+struct RunFormat
+{
+    static constexpr char magic[4] = { 'N', 'R', 'U', 'N' }; ///< first bytes of the file
+    static constexpr std::uint32_t version = 1; ///< version of the file format
+    static constexpr std::size_t key_bytes = Key::words * sizeof(std::uint64_t); ///< size of the unpacked key
+    static constexpr std::size_t count_offset = sizeof(magic) + 2 * sizeof(std::uint32_t); ///< offset of the number of keys
+
+    using Bytes = std::array<std::uint8_t, key_bytes>;
+
+    static Bytes encode(const Key &key) noexcept
+    {
+        auto bytes = Bytes{};
+
+        for (std::size_t i = 0; i < key_bytes; i++)
+        {
+            bytes[i] = static_cast<std::uint8_t>(key.data[i / 8] >> (56 - i % 8 * 8));
+        }
+
+        return bytes;
+    }
+
+    static Key decode(const Bytes &bytes) noexcept
+    {
+        auto key = Key{};
+
+        for (std::size_t i = 0; i < key_bytes; i++)
+        {
+            key.data[i / 8] = (key.data[i / 8] << 8) | bytes[i];
+        }
+
+        return key;
+    }
+};
+
+/**
+* \brief Writes sorted keys to a run file
+*
+* @tparam Key packed board encoding
+*/
+template <typename Key>
+class RunWriter
+{
+public:
+    explicit RunWriter(const std::string &path)
+        : stream_{ path, std::ios::binary | std::ios::trunc }
+    {
+        const std::uint32_t key_bytes = Format::key_bytes;
+        const std::uint64_t count = 0;
+
+        write(Format::magic, sizeof(Format::magic));
+        write(&Format::version, sizeof(Format::version));
+        write(&key_bytes, sizeof(key_bytes));
+        write(&count, sizeof(count));
+    }
+
+    /**
+    * \brief Appends the key, keys have to come in ascending order
+    */
+    void push(const Key &key)
+    {
+        const auto bytes = Format::encode(key);
+        std::size_t shared = 0;
+
+        while (count_ > 0 && shared < Format::key_bytes && bytes[shared] == last_[shared])
+        {
+            ++shared;
+        }
+
+        stream_.put(static_cast<char>(shared));
+        write(bytes.data() + shared, Format::key_bytes - shared);
+
+        last_ = bytes;
+        ++count_;
+    }
+
+    std::uint64_t size() const noexcept
+    {
+        return count_;
+    }
+
+    /**
+    * \brief Stores the number of keys and closes the file
+    *
+    * @return True if everything was written, false otherwise
+    */
+    bool close()
+    {
+        stream_.seekp(Format::count_offset);
+        write(&count_, sizeof(count_));
+        stream_.close();
+
+        return !stream_.fail();
+    }
+
+private:
+    using Format = RunFormat<Key>;
+
+    std::ofstream stream_; ///< file itself
+    typename Format::Bytes last_{}; ///< previous key
+    std::uint64_t count_{ 0 }; ///< number of written keys
+
+    void write(const void *value, std::size_t size)
+    {
+        stream_.write(static_cast<const char*>(value), static_cast<std::streamsize>(size));
+    }
+};
+
+/**
+* \brief Reads keys of a run file in order
+*
+* @tparam Key packed board encoding
+*/
+template <typename Key>
+class RunReader
+{
+public:
+    explicit RunReader(const std::string &path)
+        : stream_{ path, std::ios::binary }
+    {
+        char magic[4]{};
+        std::uint32_t version{}, key_bytes{};
+
+        read(magic, sizeof(magic));
+        read(&version, sizeof(version));
+        read(&key_bytes, sizeof(key_bytes));
+        read(&count_, sizeof(count_));
+
+        is_open_ = static_cast<bool>(stream_) && std::memcmp(magic, Format::magic, sizeof(magic)) == 0
+            && version == Format::version && key_bytes == Format::key_bytes;
+    }
+
+    /**
+    * \brief Reads the next key
+    *
+    * @return True if the key was read, false at the end of the file or on error
+    */
+    bool next(Key &key)
+    {
+        if (!is_open_ || read_ == count_)
+        {
+            return false;
+        }
+
+        const auto shared = static_cast<std::size_t>(stream_.get());
+        read(last_.data() + std::min(shared, Format::key_bytes), Format::key_bytes - std::min(shared, Format::key_bytes));
+
+        if (!stream_ || shared > Format::key_bytes)
+        {
+            is_open_ = false;
+            return false;
+        }
+
+        key = Format::decode(last_);
+        ++read_;
+
+        return true;
+    }
+
+    std::uint64_t size() const noexcept
+    {
+        return count_;
+    }
+
+    /**
+    * \brief Checks whether the file is valid and every record read so far was complete
+    */
+    bool good() const noexcept
+    {
+        return is_open_;
+    }
+
+private:
+    using Format = RunFormat<Key>;
+
+    std::ifstream stream_; ///< file itself
+    typename Format::Bytes last_{}; ///< previous key
+    std::uint64_t count_{ 0 }; ///< number of keys in the file
+    std::uint64_t read_{ 0 }; ///< number of keys read so far
+    bool is_open_{ false }; ///< false if the file is missing, malformed or truncated
+
+    void read(void *value, std::size_t size)
+    {
+        stream_.read(static_cast<char*>(value), static_cast<std::streamsize>(size));
+    }
+};
+
+/**
+* \brief Breadth-first search which keeps its levels on disk
+*
+* \details Every level is a run file of its boards sorted by the packed key.
+* Successors of the last level are collected in memory up to the given budget,
+* sorted and spilled to temporary runs, which are then merged into the next level.
+* Duplicates are dropped by the merge itself: a board repeats either within the new level
+* or in one of the two previous levels, since neighbours of a board lie at most one level away.
+* Those levels are streamed alongside the runs, so no set of visited boards is kept in memory.
+*
+* Manifest in the directory lists the root and the size of every completed level.
+* Level file is renamed into place before the manifest mentions it and the manifest is replaced by rename too,
+* so a search created over the same directory resumes from the last completed level after a crash.
+* Levels stay on disk: they answer later queries and hold the exact distance distribution,
+* the last non-empty level is the set of the hardest boards.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class ExternalBreadthFirstSearch
+{
+public:
+    using Key = typename GameBoard<Rows, Cols>::Key;
+
+    static constexpr std::size_t default_memory = std::size_t{ 1 } << 28; ///< bytes of successors kept in memory
+    static constexpr std::size_t not_found = SIZE_MAX; ///< depth of boards which can't be reached
+
+    ExternalBreadthFirstSearch() = delete;
+
+    /**
+    * @param root board from which the levels are counted
+    * @param directory directory of the level files, created if missing
+    * @param memory bytes of successors sorted in memory before they are spilled to a run
+    */
+    ExternalBreadthFirstSearch(const GameBoard<Rows, Cols> &root, const std::string &directory, std::size_t memory = default_memory);
+
+    /**
+    * \brief Checks whether the directory is usable
+    *
+    * \details Search is closed if the manifest belongs to another root or size,
+    * or if reading or writing of a level failed
+    */
+    bool is_open() const noexcept
+    {
+        return is_open_;
+    }
+
+    /**
+    * \brief Checks whether every board reachable from the root is found
+    */
+    bool is_complete() const noexcept
+    {
+        return !sizes_.empty() && sizes_.back() == 0;
+    }
+
+    /**
+    * \brief Returns number of boards at every distance from the root
+    */
+    const std::vector<std::uint64_t>& level_sizes() const noexcept
+    {
+        return sizes_;
+    }
+
+    const SearchStats& stats() const noexcept
+    {
+        return stats_;
+    }
+
+    std::string level_path(std::size_t depth) const;
+
+    bool expand();
+    bool run(std::size_t max_depth = SIZE_MAX);
+
+    /**
+    * \brief Calls the visitor with every board of the level
+    *
+    * @return True if the whole level was read, false otherwise
+    */
+    template <typename Visitor>
+    bool for_each(std::size_t depth, Visitor visitor) const
+    {
+        auto reader = RunReader<Key>(level_path(depth));
+        auto key = Key{};
+
+        while (reader.next(key))
+        {
+            visitor(GameBoard<Rows, Cols>(key));
+        }
+
+        return reader.good();
+    }
+
+    std::size_t find(const GameBoard<Rows, Cols> &board, SearchControl *control = nullptr);
+    Solution<Rows, Cols> solve(const GameBoard<Rows, Cols> &initial, SearchControl *control = nullptr);
+
+private:
+    using Source = std::function<bool(Key&)>;
+
+    std::filesystem::path directory_{}; ///< directory of the level files and the manifest
+    Key root_{}; ///< root board
+    std::size_t capacity_{ 1 }; ///< number of successors sorted in memory
+    std::vector<std::uint64_t> sizes_{}; ///< number of boards of every completed level
+    SearchStats stats_{}; ///< counters of the expansions done by this object
+    bool is_open_{ false }; ///< false if the directory isn't usable
+
+    static constexpr const char *manifest_header_ = "n-puzzle external breadth-first search 2"; ///< first line of the manifest
+
+    bool read_manifest();
+    bool write_manifest() const;
+    bool spill(std::vector<Key> &keys, std::size_t run);
+    bool merge(std::vector<Source> sources, std::size_t depth, std::uint64_t &count);
+
+    std::string run_path(std::size_t run) const
+    {
+        return (directory_ / ("run-" + std::to_string(run) + ".tmp")).string();
+    }
+
+    bool contains(std::size_t depth, const Key &key) const;
+};
+
+template <std::size_t Rows, std::size_t Cols>
+ExternalBreadthFirstSearch<Rows, Cols>::ExternalBreadthFirstSearch(const GameBoard<Rows, Cols> &root, const std::string &directory, std::size_t memory)
+    : directory_{ directory }, root_{ root.key() }, capacity_{ std::max<std::size_t>(memory / sizeof(Key), 16) }
+{
+    auto error = std::error_code{};
+    std::filesystem::create_directories(directory_, error);
+
+    if (std::filesystem::exists(directory_ / "manifest", error))
+    {
+        is_open_ = read_manifest();
+        return;
+    }
+
+    auto writer = RunWriter<Key>((directory_ / "level.tmp").string());
+    writer.push(root_);
+
+    if (writer.close())
+    {
+        std::filesystem::rename(directory_ / "level.tmp", level_path(0), error);
+
+        sizes_ = { 1 };
+        is_open_ = !error && write_manifest();
+    }
+}
+
+/**
+* \brief Returns path of the file with boards of the given level
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::string ExternalBreadthFirstSearch<Rows, Cols>::level_path(std::size_t depth) const
+{
+    auto name = std::ostringstream{};
+    name << "level-" << std::setw(3) << std::setfill('0') << depth << ".run";
+
+    return (directory_ / name.str()).string();
+}
+
+/**
+* \brief Finds the next level of the search
+*
+* \details Boards of the last level are read once, their successors are spilled to sorted runs
+* whenever the memory budget is exhausted. Last run stays in memory and is merged along with the others.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @return True if the level was added, false if the search is complete or an error occurred
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::expand()
+{
+    if (!is_open_ || is_complete())
+    {
+        return false;
+    }
+
+    const auto depth = sizes_.size() - 1;
+    const auto generated = stats_.generated;
+    auto frontier = RunReader<Key>(level_path(depth));
+    auto successors = std::vector<Key>{};
+    auto key = Key{};
+    std::size_t runs = 0;
+
+    successors.reserve(capacity_);
+
+    while (frontier.next(key))
+    {
+        const auto board = GameBoard<Rows, Cols>(key);
+        ++stats_.expanded;
+
+        for (Direction direction : { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT })
+        {
+            auto temp = board.move(direction);
+
+            if (temp.is_init())
+            {
+                successors.push_back(temp.key());
+                ++stats_.generated;
+            }
+        }
+
+        if (successors.size() + 4 > capacity_ && !spill(successors, runs++))
+        {
+            is_open_ = false;
+            return false;
+        }
+    }
+
+    if (!frontier.good())
+    {
+        is_open_ = false;
+        return false;
+    }
+
+    std::sort(successors.begin(), successors.end());
+
+    auto readers = std::vector< std::unique_ptr< RunReader<Key> > >{};
+    auto sources = std::vector<Source>{};
+
+    for (std::size_t run = 0; run < runs; run++)
+    {
+        readers.push_back(std::make_unique< RunReader<Key> >(run_path(run)));
+        sources.push_back([reader = readers.back().get()](Key &next) { return reader->next(next); });
+    }
+
+    sources.push_back([&successors, position = std::size_t{ 0 }](Key &next) mutable
+    {
+        if (position == successors.size())
+        {
+            return false;
+        }
+
+        next = successors[position++];
+
+        return true;
+    });
+
+    auto count = std::uint64_t{ 0 };
+    bool is_merged = merge(std::move(sources), depth, count);
+
+    for (const auto &reader : readers)
+    {
+        is_merged = is_merged && reader->good();
+    }
+
+    auto error = std::error_code{};
+
+    for (std::size_t run = 0; run < runs; run++)
+    {
+        std::filesystem::remove(run_path(run), error);
+    }
+
+    if (is_merged)
+    {
+        std::filesystem::rename(directory_ / "level.tmp", level_path(depth + 1), error);
+        is_merged = !error;
+    }
+
+    if (!is_merged)
+    {
+        is_open_ = false;
+        return false;
+    }
+
+    sizes_.push_back(count);
+
+    stats_.duplicates += stats_.generated - generated - count;
+    stats_.peak_open = std::max<std::size_t>(stats_.peak_open, count);
+    stats_.peak_closed += count;
+    stats_.bytes = capacity_ * sizeof(Key);
+
+    is_open_ = write_manifest();
+
+    return is_open_;
+}
+
+/**
+* \brief Expands levels until every reachable board is found or the depth is reached
+*
+* @return True if no error occurred, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::run(std::size_t max_depth)
+{
+    while (is_open_ && !is_complete() && sizes_.size() <= max_depth)
+    {
+        expand();
+    }
+
+    return is_open_;
+}
+
+/**
+* \brief Finds distance of the board from the root
+*
+* \details Levels found already are scanned first, then the search goes on until the board shows up.
+* Control is looked at before every new level, levels completed before the stop stay on disk for the next search.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param board searched board
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Depth of the board, not_found if the board can't be reached, an error occurred or the control stopped the search
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::size_t ExternalBreadthFirstSearch<Rows, Cols>::find(const GameBoard<Rows, Cols> &board, SearchControl *control)
+{
+    for (std::size_t depth = 0; is_open_; depth++)
+    {
+        if (depth == sizes_.size()
+            && (is_stopped(control, stats_.expanded, [&] { return SearchProgress{ stats_.expanded, stats_.generated, depth, stats_.bytes }; })
+                || !expand()))
+        {
+            break;
+        }
+
+        if (contains(depth, board.key()))
+        {
+            return depth;
+        }
+    }
+
+    return not_found;
+}
+
+/**
+* \brief Finds shortest path from the board to the root
+*
+* \details Every board at depth d has a neighbour at depth d-1,
+* one scan of every level closer to the root is enough to restore the path
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param control cancellation, progress and memory cap of the search or nullptr
+*
+* @return Shortest solution, not found solution if the root can't be reached or the control stopped the search
+*/
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> ExternalBreadthFirstSearch<Rows, Cols>::solve(const GameBoard<Rows, Cols> &initial, SearchControl *control)
+{
+    const auto depth = find(initial, control);
+
+    if (depth == not_found)
+    {
+        return {};
+    }
+
+    auto board = initial;
+    auto moves = std::vector<Direction>{};
+
+    for (std::size_t level = depth; level-- > 0; )
+    {
+        auto reader = RunReader<Key>(level_path(level));
+        auto neighbours = std::vector< std::pair<Key, Direction> >{};
+
+        for (Direction direction : { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT })
+        {
+            auto temp = board.move(direction);
+
+            if (temp.is_init())
+            {
+                neighbours.push_back({ temp.key(), direction });
+            }
+        }
+
+        std::sort(neighbours.begin(), neighbours.end());
+
+        auto key = Key{};
+        auto found = neighbours.end();
+
+        for (auto iter = neighbours.begin(); iter != neighbours.end() && found == neighbours.end() && reader.next(key); )
+        {
+            while (iter != neighbours.end() && iter->first < key)
+            {
+                ++iter;
+            }
+
+            if (iter != neighbours.end() && iter->first == key)
+            {
+                found = iter;
+            }
+        }
+
+        // Levels don't agree with each other, the directory was altered
+        if (found == neighbours.end())
+        {
+            is_open_ = false;
+            return {};
+        }
+
+        moves.push_back(found->second);
+        board = board.move(found->second);
+    }
+
+    return { initial, moves, stats_.expanded };
+}
+
+/**
+* \brief Sorts the keys and writes them to the temporary run
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::spill(std::vector<Key> &keys, std::size_t run)
+{
+    std::sort(keys.begin(), keys.end());
+
+    auto writer = RunWriter<Key>(run_path(run));
+
+    for (std::size_t i = 0; i < keys.size(); i++)
+    {
+        if (i == 0 || keys[i] != keys[i - 1])
+        {
+            writer.push(keys[i]);
+        }
+    }
+
+    keys.clear();
+
+    return writer.close();
+}
+
+/**
+* \brief Merges sorted sources into the next level
+*
+* \details Sources are merged through a heap, equal keys come out one after another.
+* Level before the last one and the last one are read in step with the merge,
+* keys found in them are boards seen before.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param sources sorted successors of the last level
+* @param depth depth of the last level
+* @param count number of boards written to the next level
+*
+* @return True if the next level was written to the temporary file, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::merge(std::vector<Source> sources, std::size_t depth, std::uint64_t &count)
+{
+    using Head = std::pair<Key, std::size_t>;
+
+    auto heads = std::priority_queue< Head, std::vector<Head>, std::greater<Head> >{};
+    auto writer = RunWriter<Key>((directory_ / "level.tmp").string());
+    auto key = Key{};
+
+    // Previous levels are read only as far as the merged keys go
+    struct Seen
+    {
+        RunReader<Key> reader;
+        Key key{};
+        bool has_key{ false };
+
+        bool contains(const Key &target)
+        {
+            while (has_key && key < target)
+            {
+                has_key = reader.next(key);
+            }
+
+            return has_key && key == target;
+        }
+    };
+
+    auto seen = std::vector< std::unique_ptr<Seen> >{};
+
+    for (std::size_t level = (depth > 0) ? depth - 1 : 0; level <= depth; level++)
+    {
+        seen.push_back(std::make_unique<Seen>(Seen{ RunReader<Key>(level_path(level)) }));
+        seen.back()->has_key = seen.back()->reader.next(seen.back()->key);
+    }
+
+    for (std::size_t i = 0; i < sources.size(); i++)
+    {
+        if (sources[i](key))
+        {
+            heads.push({ key, i });
+        }
+    }
+
+    auto last = Key{};
+
+    while (!heads.empty())
+    {
+        auto [next, source] = heads.top();
+        heads.pop();
+
+        if (sources[source](key))
+        {
+            heads.push({ key, source });
+        }
+
+        if (count > 0 && next == last)
+        {
+            continue;
+        }
+
+        const bool is_seen = std::any_of(seen.begin(), seen.end(), [&next](const auto &level) { return level->contains(next); });
+
+        if (!is_seen)
+        {
+            writer.push(next);
+            last = next;
+            ++count;
+        }
+    }
+
+    bool is_read = true;
+
+    for (const auto &level : seen)
+    {
+        is_read = is_read && level->reader.good();
+    }
+
+    return writer.close() && is_read;
+}
+
+/**
+* \brief Restores completed levels from the manifest
+*
+* @return True if the manifest describes the same root and its last two levels exist, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::read_manifest()
+{
+    auto stream = std::ifstream(directory_ / "manifest");
+    auto header = std::string{};
+    auto word = std::string{};
+    auto root = Key{};
+    std::size_t rows{}, cols{}, depth{};
+    std::uint64_t count{};
+
+    std::getline(stream, header);
+
+    if (header != manifest_header_ || !(stream >> word >> rows >> cols) || word != "size" || rows != Rows || cols != Cols
+        || !(stream >> word) || word != "root")
+    {
+        return false;
+    }
+
+    for (auto &bits : root.data)
+    {
+        stream >> std::hex >> bits >> std::dec;
+    }
+
+    if (!stream || root != root_)
+    {
+        return false;
+    }
+
+    while (stream >> word >> depth >> count)
+    {
+        if (word != "level" || depth != sizes_.size())
+        {
+            return false;
+        }
+
+        sizes_.push_back(count);
+    }
+
+    auto error = std::error_code{};
+
+    // Expansion needs the last level and the one before it
+    for (std::size_t level = sizes_.size(); level-- > 0 && level + 2 >= sizes_.size(); )
+    {
+        if (!std::filesystem::exists(level_path(level), error))
+        {
+            return false;
+        }
+    }
+
+    return !sizes_.empty();
+}
+
+/**
+* \brief Replaces the manifest with the one listing every completed level
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::write_manifest() const
+{
+    {
+        auto stream = std::ofstream(directory_ / "manifest.tmp", std::ios::trunc);
+
+        stream << manifest_header_ << "\nsize " << Rows << ' ' << Cols << "\nroot" << std::hex;
+
+        for (auto bits : root_.data)
+        {
+            stream << ' ' << bits;
+        }
+
+        stream << std::dec << '\n';
+
+        for (std::size_t depth = 0; depth < sizes_.size(); depth++)
+        {
+            stream << "level " << depth << ' ' << sizes_[depth] << '\n';
+        }
+
+        stream.close();
+
+        if (stream.fail())
+        {
+            return false;
+        }
+    }
+
+    auto error = std::error_code{};
+    std::filesystem::rename(directory_ / "manifest.tmp", directory_ / "manifest", error);
+
+    return !error;
+}
+
+/**
+* \brief Checks whether the level holds the key, sorted order lets the scan stop early
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool ExternalBreadthFirstSearch<Rows, Cols>::contains(std::size_t depth, const Key &key) const
+{
+    auto reader = RunReader<Key>(level_path(depth));
+    auto next = Key{};
+
+    while (reader.next(next))
+    {
+        if (!(next < key))
+        {
+            return next == key;
+        }
+    }
+
+    return false;
+}
+
+#endif // EXTERNAL_SEARCH_H_
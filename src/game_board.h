@@ -24,8 +24,9 @@
 #include <cstdint>
 #include <cmath>
 #include <array>
-#include <memory>
-#include <list>
+
+#include "board_key.h"
+#include "output_buffer.h"
 
 /**
 * \brief Direction enum class
@@ -33,30 +34,166 @@
 * \details Contains member for moving in four directions:
 * down, left, up, right
 */
-enum class Direction {
+enum class Direction : std::uint8_t {
     DOWN, ///< down direction
     LEFT, ///< left direction
     UP, ///< up direction
     RIGHT ///< right direction
 };
 
+/**
+* \brief Returns direction which undoes the given one
+*
+* @param direction direction of the move
+*
+* @return Opposite direction
+*/
+constexpr Direction opposite(Direction direction) noexcept
+{
+    switch (direction)
+    {
+    case Direction::DOWN:
+        return Direction::UP;
+
+    case Direction::LEFT:
+        return Direction::RIGHT;
+
+    case Direction::UP:
+        return Direction::DOWN;
+
+    default:
+        return Direction::LEFT;
+    }
+}
+
+/**
+* \brief Converts tile label to the tile id
+*
+* \details Labels are '1'-'9', then 'A'-'Z' and 'a'-'z',
+* blank tile ' ' has id 0
+*
+* @param label tile label as it is shown on the board
+*
+* @return Numeric id of the tile
+*/
+constexpr std::uint8_t tile_id(char label) noexcept
+{
+    if (label >= '1' && label <= '9')
+    {
+        return static_cast<std::uint8_t>(label - '0');
+    }
+    else if (label >= 'A' && label <= 'Z')
+    {
+        return static_cast<std::uint8_t>(label - 'A' + 10);
+    }
+    else if (label >= 'a' && label <= 'z')
+    {
+        return static_cast<std::uint8_t>(label - 'a' + 36);
+    }
+
+    return 0;
+}
+
+/**
+* \brief Converts tile id to the tile label
+*
+* \details Inverse of tile_id()
+*
+* @param id numeric id of the tile
+*
+* @return Label of the tile as it is shown on the board
+*/
+constexpr char tile_label(std::uint8_t id) noexcept
+{
+    if (id == 0)
+    {
+        return ' ';
+    }
+    else if (id <= 9)
+    {
+        return static_cast<char>('0' + id);
+    }
+    else if (id < 36)
+    {
+        return static_cast<char>('A' + id - 10);
+    }
+
+    return static_cast<char>('a' + id - 36);
+}
+
+/**
+* \brief Cells of the board and moves between them, computed at compile time for every shape
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+struct BoardGeometry
+{
+    static_assert(Rows * Cols < 0xFF, "cells are addressed by one byte");
+
+    static constexpr std::size_t cells = Rows * Cols; ///< number of cells on the board
+    static constexpr std::uint8_t no_cell = 0xFF; ///< neighbour of a cell on the border of the board
+
+    using Neighbours = std::array< std::array<std::uint8_t, 4>, cells >;
+
+    /**
+    * \brief Cell which the blank reaches from every cell in every direction, indexed by cell and then by Direction
+    */
+    static constexpr Neighbours neighbours = []
+    {
+        auto table = Neighbours{};
+
+        for (std::size_t cell = 0; cell < cells; cell++)
+        {
+            const auto row = cell / Cols;
+            const auto col = cell % Cols;
+
+            table[cell][static_cast<std::size_t>(Direction::DOWN)] = static_cast<std::uint8_t>(row + 1 < Rows ? cell + Cols : no_cell);
+            table[cell][static_cast<std::size_t>(Direction::LEFT)] = static_cast<std::uint8_t>(col > 0 ? cell - 1 : no_cell);
+            table[cell][static_cast<std::size_t>(Direction::UP)] = static_cast<std::uint8_t>(row > 0 ? cell - Cols : no_cell);
+            table[cell][static_cast<std::size_t>(Direction::RIGHT)] = static_cast<std::uint8_t>(col + 1 < Cols ? cell + 1 : no_cell);
+        }
+
+        return table;
+    }();
+
+    /**
+    * \brief Checks whether the blank in the given cell can move in the given direction
+    */
+    static constexpr bool can_move(std::size_t cell, Direction direction) noexcept
+    {
+        return neighbours[cell][static_cast<std::size_t>(direction)] != no_cell;
+    }
+};
+
 /**
 * \brief Game board for n-puzzle
 *
-* \details Represents n*n game board for n-puzzle
+* \details Represents Rows*Cols game board for n-puzzle.
+* Tiles are kept only as numeric ids in the packed key, blank tile has id 0,
+* moves swap two ids of the key and look the neighbour up in BoardGeometry.
 *
-* @tparam Size stands for the size of the board 
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board, the board is square by default
 */
-template <std::size_t Size>
+template <std::size_t Rows, std::size_t Cols = Rows>
 class GameBoard
 {
 public:
+    static constexpr std::size_t rows = Rows; ///< number of rows
+    static constexpr std::size_t cols = Cols; ///< number of columns
+    static constexpr std::size_t cells = Rows * Cols; ///< number of cells
+
+    using Key = BoardKey<cells>; ///< packed encoding of the board
+    using Geometry = BoardGeometry<Rows, Cols>; ///< moves between cells
+
     GameBoard() = default;
-    explicit GameBoard(std::array< std::array< char, Size >, Size > board);
+    explicit GameBoard(std::array< std::array< char, Cols >, Rows > board);
+    explicit GameBoard(const Key &key);
 
     GameBoard move(Direction direction) const noexcept;
-
-    void show_path() const noexcept;
+    bool apply(Direction direction) noexcept;
 
     /**
     * \brief Checks whether board is initialized or not
@@ -71,25 +208,47 @@ public:
         return is_init_;
     }
 
-    static float manhattan_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept;
-    static float euclidean_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept;
-    static float chebyshev_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept;
-
-    template <std::size_t Size>
-    friend bool operator==(const GameBoard<Size> &lhs, const GameBoard<Size> &rhs);
+    /**
+    * \brief Returns packed encoding of the board
+    *
+    * \details Key is kept up to date by every move,
+    * so it costs nothing to use it for hashing and comparison
+    */
+    const Key& key() const noexcept
+    {
+        return key_;
+    }
 
-    template <std::size_t Size>
-    friend std::ostream& operator<<(std::ostream &stream, const GameBoard<Size> &board);
+    /**
+    * \brief Returns id of the tile in the given cell
+    *
+    * @param cell index of the cell, cells are numbered row by row
+    */
+    std::uint8_t tile(std::size_t cell) const noexcept
+    {
+        return key_.get(cell);
+    }
 
-private:
-    static constexpr uint16_t size_ = static_cast<uint16_t>(Size);
+    /**
+    * \brief Returns index of the cell with the blank tile
+    */
+    std::size_t blank_cell() const noexcept
+    {
+        return blank_;
+    }
 
-    char board_[Size][Size]{}; ///< actual game board with blank tile
-    int row_blank_{ -1 }; ///< row position of the blank tile
-    int col_blank_{ -1 }; ///< column position of the blank tile
+    static float manhattan_distance(const GameBoard &begin, const GameBoard &end) noexcept;
+    static float euclidean_distance(const GameBoard &begin, const GameBoard &end) noexcept;
+    static float chebyshev_distance(const GameBoard &begin, const GameBoard &end) noexcept;
 
-    std::shared_ptr< GameBoard > parent{ nullptr }; ///< parent of the board in the search tree
+    friend bool operator==(const GameBoard &lhs, const GameBoard &rhs) noexcept
+    {
+        return lhs.key_ == rhs.key_;
+    }
 
+private:
+    Key key_{}; ///< packed encoding of the board
+    std::uint8_t blank_{ Geometry::no_cell }; ///< cell of the blank tile
     bool is_init_{ false }; ///< true if the board is initialized, false otherwise
 
     struct TilePosition
@@ -98,34 +257,40 @@ private:
         uint16_t col;
     };
 
-    TilePosition find_tile(char searched_value) const noexcept;
+    using TilePositions = std::array<TilePosition, std::size_t{ 1 } << Key::bits>;
 
-    void move_down(GameBoard &board) const noexcept;
-    void move_left(GameBoard &board) const noexcept;
-    void move_up(GameBoard &board) const noexcept;
-    void move_right(GameBoard &board) const noexcept;
+    TilePositions tile_positions() const noexcept;
 };
 
 /**
 * \brief Handle for 0*0 board
 */
 template<>
-class GameBoard<0> {};
+class GameBoard<0, 0> {};
 
 
-template <std::size_t Size>
-GameBoard<Size>::GameBoard(std::array< std::array< char, Size >, Size > board)
+/**
+* \brief Creates the board from tile labels
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param board labels of tiles row by row, ' ' is the blank
+*/
+template <std::size_t Rows, std::size_t Cols>
+GameBoard<Rows, Cols>::GameBoard(std::array< std::array< char, Cols >, Rows > board)
 {
-    for (int i = 0; i < size_; i++)
+    for (std::size_t row = 0; row < Rows; row++)
     {
-        for (int j = 0; j < size_; j++)
+        for (std::size_t col = 0; col < Cols; col++)
         {
-            board_[i][j] = board.at(i).at(j);
+            const auto tile = tile_id(board.at(row).at(col));
 
-            if (board_[i][j] == ' ')
+            key_.set(row * Cols + col, tile);
+
+            if (tile == 0)
             {
-                row_blank_ = i;
-                col_blank_ = j;
+                blank_ = static_cast<std::uint8_t>(row * Cols + col);
             }
         }
     }
@@ -133,149 +298,120 @@ GameBoard<Size>::GameBoard(std::array< std::array< char, Size >, Size > board)
     is_init_ = true;
 }
 
-template <std::size_t Size>
-GameBoard<Size> GameBoard<Size>::move(Direction direction) const noexcept
+/**
+* \brief Restores the board from its packed encoding
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param key packed encoding of the board
+*/
+template <std::size_t Rows, std::size_t Cols>
+GameBoard<Rows, Cols>::GameBoard(const Key &key)
+    : key_{ key }
 {
-    GameBoard<Size> result;
-
-    switch (direction)
+    for (std::size_t cell = 0; cell < cells; cell++)
     {
-    case Direction::DOWN:
-        move_down(result);
-        break;
-
-    case Direction::LEFT:
-        move_left(result);
-        break;
-
-    case Direction::UP:
-        move_up(result);
-        break;
-
-    case Direction::RIGHT:
-        move_right(result);
-        break;
+        if (key_.get(cell) == 0)
+        {
+            blank_ = static_cast<std::uint8_t>(cell);
+        }
     }
 
-    return result;
+    is_init_ = true;
 }
 
-template <std::size_t Size>
-void GameBoard<Size>::move_down(GameBoard<Size> &board) const noexcept
+/**
+* \brief Moves blank tile
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param direction direction in which blank tile is moved
+*
+* @return Board after the move, uninitialized board if the move isn't possible
+*/
+template <std::size_t Rows, std::size_t Cols>
+GameBoard<Rows, Cols> GameBoard<Rows, Cols>::move(Direction direction) const noexcept
 {
-    if (row_blank_ == (size_ - 1))
-    {
-        return;
-    }
-
-    board = *this;
-
-    // Swap blank cell with lower cell
-    board.board_[row_blank_][col_blank_] = board_[row_blank_ + 1][col_blank_];
-    board.board_[row_blank_ + 1][col_blank_] = ' ';
+    auto result = *this;
 
-    board.parent = std::make_shared<GameBoard<Size>>(*this);
-
-    ++board.row_blank_;
-}
-
-template <std::size_t Size>
-void GameBoard<Size>::move_left(GameBoard<Size> &board) const noexcept
-{
-    if (col_blank_ == 0)
+    if (!result.apply(direction))
     {
-        return;
+        return {};
     }
 
-    board = *this;
-
-    // Swap blank cell with left cell
-    board.board_[row_blank_][col_blank_] = board_[row_blank_][col_blank_ - 1];
-    board.board_[row_blank_][col_blank_ - 1] = ' ';
-
-    board.parent = std::make_shared<GameBoard<Size>>(*this);
-
-    --board.col_blank_;
+    return result;
 }
 
-template <std::size_t Size>
-void GameBoard<Size>::move_up(GameBoard<Size> &board) const noexcept
+/**
+* \brief Moves blank tile in place
+*
+* \details Changes the board itself instead of making a copy,
+* the move is undone by applying the opposite direction
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param direction direction in which blank tile is moved
+*
+* @return True if the move was possible, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool GameBoard<Rows, Cols>::apply(Direction direction) noexcept
 {
-    if (row_blank_ == 0)
+    if (!is_init_)
     {
-        return;
+        return false;
     }
 
-    board = *this;
-
-    // Swap blank cell with upper cell
-    board.board_[row_blank_][col_blank_] = board_[row_blank_ - 1][col_blank_];
-    board.board_[row_blank_ - 1][col_blank_] = ' ';
+    const auto cell = Geometry::neighbours[blank_][static_cast<std::size_t>(direction)];
 
-    board.parent = std::make_shared<GameBoard<Size>>(*this);
-
-    --board.row_blank_;
-}
-
-template <std::size_t Size>
-void GameBoard<Size>::move_right(GameBoard<Size> &board) const noexcept
-{
-    if (col_blank_ == (size_ - 1))
+    if (cell == Geometry::no_cell)
     {
-        return;
+        return false;
     }
 
-    board = *this;
-
-    // Swap blank cell with right cell
-    board.board_[row_blank_][col_blank_] = board_[row_blank_][col_blank_ + 1];
-    board.board_[row_blank_][col_blank_ + 1] = ' ';
-
-    board.parent = std::make_shared<GameBoard<Size>>(*this);
-
-    ++board.col_blank_;
-}
-
-template <std::size_t Size>
-void GameBoard<Size>::show_path() const noexcept
-{
-    auto path = std::list<GameBoard<Size>>{};
-    auto trace = std::make_shared<GameBoard<Size>>(*this);
-
-    while (trace != nullptr)
-    {
-        path.push_back(*trace);
-        trace = trace->parent;
-    }
+    // Swap blank cell with the neighbour
+    key_.set(blank_, key_.get(cell));
+    key_.set(cell, 0);
+    blank_ = cell;
 
-    auto iter = path.crbegin();
-    while (iter != path.rend())
-    {
-        std::cout << *(iter++);
-    }
+    return true;
 }
 
 /**
 * \brief Computes manhattan distance
 *
-* \details Computes manhattan distance from current board to the target board
+* \details Computes manhattan distance from current board to the target board,
+* blank tile is not counted, so the distance never exceeds the number of moves
 *
-* @tparam Size stands for the size of the board
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
 * @param target board to which distance will be computed
 *
 * @return Manhattan distance from current board to the target board
 */
-template <std::size_t Size>
-float GameBoard<Size>::manhattan_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept
+template <std::size_t Rows, std::size_t Cols>
+float GameBoard<Rows, Cols>::manhattan_distance(const GameBoard &begin, const GameBoard &end) noexcept
 {
+    const auto positions = end.tile_positions();
     uint16_t distance{};
 
-    for (uint16_t i = 0; i < size_; i++)
+    for (uint16_t i = 0; i < Rows; i++)
     {
-        for (uint16_t j = 0; j < size_; j++)
+        for (uint16_t j = 0; j < Cols; j++)
         {
-            auto[row, col] = end.find_tile(begin.board_[i][j]);
+            const auto tile = begin.key_.get(i * Cols + j);
+
+            // Blank tile isn't counted, otherwise distance overestimates the number of moves
+            if (tile == 0)
+            {
+                continue;
+            }
+
+            auto[row, col] = positions[tile];
 
             distance += abs(row - i) + abs(col - j);
         }
@@ -287,26 +423,39 @@ float GameBoard<Size>::manhattan_distance(const GameBoard<Size> &begin, const Ga
 /**
 * \brief Computes euclidean distance
 *
-* \details Computes euclidean distance from current board to the target board
+* \details Computes euclidean distance from current board to the target board,
+* blank tile is not counted
 *
-* @tparam Size stands for the size of the board
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
 * @param target board to which distance will be computed
 *
 * @return Euclidean distance from current board to the target board
 */
-template <std::size_t Size>
-float GameBoard<Size>::euclidean_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept
+template <std::size_t Rows, std::size_t Cols>
+float GameBoard<Rows, Cols>::euclidean_distance(const GameBoard &begin, const GameBoard &end) noexcept
 {
+    const auto positions = end.tile_positions();
     float distance{};
 
-    for (uint16_t i = 0; i < size_; i++)
+    for (uint16_t i = 0; i < Rows; i++)
     {
-        for (uint16_t j = 0; j < size_; j++)
+        for (uint16_t j = 0; j < Cols; j++)
         {
-            auto[row, col] = end.find_tile(begin.board_[i][j]);
+            const auto tile = begin.key_.get(i * Cols + j);
 
-            distance += static_cast<float>(pow( (pow(row - i, 2) + pow(col - j, 2)) , 0.5));
+            // Skip blank tile
+            if (tile == 0)
+            {
+                continue;
+            }
+
+            auto[row, col] = positions[tile];
+            auto rows = row - i;
+            auto cols = col - j;
+
+            distance += std::sqrt(static_cast<float>(rows * rows + cols * cols));
         }
     }
 
@@ -316,24 +465,35 @@ float GameBoard<Size>::euclidean_distance(const GameBoard<Size> &begin, const Ga
 /**
 * \brief Computes Chebyshev distance
 *
-* \details Computes Chebyshev distance from current board to the target board
+* \details Computes Chebyshev distance from current board to the target board,
+* blank tile is not counted
 *
-* @tparam Size stands for the size of the board
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
 * @param target board to which distance will be computed
 *
 * @return Chebyshev distance from current board to the target board
 */
-template <std::size_t Size>
-float GameBoard<Size>::chebyshev_distance(const GameBoard<Size> &begin, const GameBoard<Size> &end) noexcept
+template <std::size_t Rows, std::size_t Cols>
+float GameBoard<Rows, Cols>::chebyshev_distance(const GameBoard &begin, const GameBoard &end) noexcept
 {
+    const auto positions = end.tile_positions();
     uint16_t distance{};
 
-    for (uint16_t i = 0; i < size_; i++)
+    for (uint16_t i = 0; i < Rows; i++)
     {
-        for (uint16_t j = 0; j < size_; j++)
+        for (uint16_t j = 0; j < Cols; j++)
         {
-            auto[row, col] = end.find_tile(begin.board_[i][j]);
+            const auto tile = begin.key_.get(i * Cols + j);
+
+            // Skip blank tile
+            if (tile == 0)
+            {
+                continue;
+            }
+
+            auto[row, col] = positions[tile];
 
             distance += ( (abs(row - i) > abs(col - j)) ? abs(row - i) : abs(col - j) );
         }
@@ -343,93 +503,93 @@ float GameBoard<Size>::chebyshev_distance(const GameBoard<Size> &begin, const Ga
 }
 
 /**
-* \brief Find tile by given tile value
+* \brief Finds positions of all tiles
 *
-* \details Find tile by given tile value and return it's coordinates as TilePosition struct
+* \details Builds lookup table of tile coordinates indexed by tile id,
+* so that distance to this board takes one pass over the other board
 *
-* @tparam Size stands for the size of the board
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
-* @param value which is to be found in the board
-*
-* @return Returns searched tile coordinates as TilePosition struct
+* @return Coordinates of every tile as TilePosition struct
 */
-template <std::size_t Size>
-typename GameBoard<Size>::TilePosition GameBoard<Size>::find_tile(char searched_value) const noexcept
+template <std::size_t Rows, std::size_t Cols>
+typename GameBoard<Rows, Cols>::TilePositions GameBoard<Rows, Cols>::tile_positions() const noexcept
 {
-    for (uint16_t i = 0; i < size_; i++)
+    auto positions = TilePositions{};
+
+    for (uint16_t i = 0; i < Rows; i++)
     {
-        for (uint16_t j = 0; j < size_; j++)
+        for (uint16_t j = 0; j < Cols; j++)
         {
-            if (board_[i][j] == searched_value)
-            {
-                return {i, j};
-            }
+            positions[key_.get(i * Cols + j)] = { i, j };
         }
     }
 
-    return {};
+    return positions;
 }
 
 /**
-* \brief Compares two strings for equality
-*
-* \details Compares two strings for equality,
-* no matter which board is their parent
+* \brief Writes board framed by lines
 *
-* @tparam Size stands for the size of the board
+* \details Every cell takes four columns, so the frame fits the board of any size
 *
-* @param lhs left-hand side of the comparison
-* @param rhs right-hand side of the comparison
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
-* @return True if the board are equal, false otherwise
+* @param buffer destination of the text
+* @param board board which will be written
 */
-template <std::size_t Size>
-bool operator==(const GameBoard<Size> &lhs, const GameBoard<Size> &rhs)
+template <std::size_t Rows, std::size_t Cols>
+void write_board(OutputBuffer &buffer, const GameBoard<Rows, Cols> &board)
 {
-    for (int i = 0; i < lhs.size_; i++)
+    auto frame = std::string{};
+
+    for (std::size_t col = 0; col < Cols; col++)
+    {
+        frame += "+---";
+    }
+
+    frame += "+\n";
+
+    for (std::size_t row = 0; row < Rows; row++)
     {
-        for (int j = 0; j < lhs.size_; j++)
+        buffer << frame;
+
+        for (std::size_t col = 0; col < Cols; col++)
         {
-            if (lhs.board_[i][j] != rhs.board_[i][j])
-            {
-                return false;
-            }
+            buffer << "| " << tile_label(board.tile(row * Cols + col)) << ' ';
         }
+
+        buffer << "|\n";
     }
 
-    return true;
+    buffer << frame;
 }
 
 /**
 * \brief Outputs board
 *
-* \details Outputs game board to the output stream
+* \details Outputs game board surrounded by empty lines to the output stream, the stream isn't flushed
 *
-* @tparam Size stands for the size of the board
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
 *
 * @param stream output stream
 * @param board board which will be printed
 *
 * @return Reference to the output stream
 */
-template <std::size_t Size>
-std::ostream& operator<<(std::ostream &stream, const GameBoard<Size> &board)
+template <std::size_t Rows, std::size_t Cols>
+std::ostream& operator<<(std::ostream &stream, const GameBoard<Rows, Cols> &board)
 {
-    stream << std::endl;
+    auto buffer = OutputBuffer{};
 
-    for (int i = 0; i < board.size_; i++)
-    {
-        stream << "+---+---+---+\n";
-        for (int j = 0; j < board.size_; j++)
-        {
-            stream << "| " << board.board_[i][j] << ' ';
-        }
-        stream << "|\n";
-    }
-    stream << "+---+---+---+\n";
+    buffer << '\n';
+    write_board(buffer, board);
+    buffer << '\n';
 
-    stream << std::endl;
-    return stream;
+    return stream << buffer.text();
 }
 
 #endif // GAME_BOARD_H_
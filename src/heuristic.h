@@ -0,0 +1,340 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HEURISTIC_H_
+#define HEURISTIC_H_
+
+#include "game_board.h"
+#include "pattern_database.h"
+#include "line_distance.h"
+#include "distance_kernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <array>
+#include <algorithm>
+
+
+enum class DistanceType
+{
+    Manhattan,
+    Euclidean,
+    Chebyshev,
+    LinearConflict, ///< Manhattan distance with linear conflicts
+    WalkingDistance
+};
+
+namespace
+{
+    /**
+    * \brief Square root usable in constant expressions, computed by Newton's method
+    */
+    constexpr double constexpr_sqrt(double value) noexcept
+    {
+        if (value <= 0.0)
+        {
+            return 0.0;
+        }
+
+        double root = value > 1.0 ? value : 1.0;
+
+        for (int i = 0; i < 64; i++)
+        {
+            root = (root + value / root) / 2.0;
+        }
+
+        return root;
+    }
+}
+
+struct ManhattanMetric
+{
+    static constexpr float between(std::size_t rows, std::size_t cols) noexcept
+    {
+        return static_cast<float>(rows + cols);
+    }
+
+    template <std::size_t Rows, std::size_t Cols>
+    static float evaluate(const DistanceKernel<Rows, Cols> &kernel, const GameBoard<Rows, Cols> &board) noexcept
+    {
+        return kernel.manhattan(board);
+    }
+};
+
+struct EuclideanMetric
+{
+    static constexpr float between(std::size_t rows, std::size_t cols) noexcept
+    {
+        return static_cast<float>(constexpr_sqrt(static_cast<double>(rows * rows + cols * cols)));
+    }
+
+    template <std::size_t Rows, std::size_t Cols>
+    static float evaluate(const DistanceKernel<Rows, Cols> &kernel, const GameBoard<Rows, Cols> &board) noexcept
+    {
+        return kernel.euclidean(board);
+    }
+};
+
+struct ChebyshevMetric
+{
+    static constexpr float between(std::size_t rows, std::size_t cols) noexcept
+    {
+        return static_cast<float>(rows > cols ? rows : cols);
+    }
+
+    template <std::size_t Rows, std::size_t Cols>
+    static float evaluate(const DistanceKernel<Rows, Cols> &kernel, const GameBoard<Rows, Cols> &board) noexcept
+    {
+        return kernel.chebyshev(board);
+    }
+};
+
+/**
+* \brief Distance which sums up distances of every tile to its goal cell
+*
+* \details Distance between every two cells is computed at compile time for the shape of the board,
+* goal cell of every tile is looked up once for the target.
+* After a move only the tile which was moved changes its cost,
+* so distance of the child is computed from the distance of the parent in O(1).
+* Full evaluation goes through DistanceKernel.
+*
+* Heuristic policies share the interface of this class: constructor taking the target and
+* an optional pattern database, evaluate() and update(). Searchers take the policy as a template parameter,
+* so both calls are resolved and inlined at compile time.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+* @tparam Metric distance between two cells
+*/
+template <std::size_t Rows, std::size_t Cols, typename Metric>
+class TileDistance
+{
+public:
+    TileDistance() = delete;
+
+    explicit TileDistance(const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols>* = nullptr)
+        : goals_{ goal_cells(target) }, kernel_{ target }
+    {}
+
+    /**
+    * \brief Computes distance of the board from scratch
+    */
+    float evaluate(const GameBoard<Rows, Cols> &board) const noexcept
+    {
+        return Metric::evaluate(kernel_, board);
+    }
+
+    /**
+    * \brief Computes distance of the board after a single move
+    *
+    * @param distance distance of the board before the move
+    * @param board board after the move
+    * @param previous_blank cell of the blank tile before the move
+    *
+    * @return Distance of the board after the move
+    */
+    float update(float distance, const GameBoard<Rows, Cols> &board, std::size_t previous_blank) const noexcept
+    {
+        const auto &costs = costs_[goals_[board.tile(previous_blank)]];
+
+        return distance - costs[board.blank_cell()] + costs[previous_blank];
+    }
+
+private:
+    static constexpr std::size_t cells_ = Rows * Cols; ///< number of cells on the board
+
+    using Costs = std::array< std::array<float, cells_>, cells_ >;
+
+    /**
+    * \brief Distance between every goal cell and every cell
+    */
+    static constexpr Costs costs_ = []
+    {
+        auto costs = Costs{};
+
+        for (std::size_t goal = 0; goal < cells_; goal++)
+        {
+            for (std::size_t cell = 0; cell < cells_; cell++)
+            {
+                const auto rows = (goal / Cols > cell / Cols) ? goal / Cols - cell / Cols : cell / Cols - goal / Cols;
+                const auto cols = (goal % Cols > cell % Cols) ? goal % Cols - cell % Cols : cell % Cols - goal % Cols;
+
+                costs[goal][cell] = Metric::between(rows, cols);
+            }
+        }
+
+        return costs;
+    }();
+
+    GoalCells<Rows, Cols> goals_; ///< goal cell of every tile of the target
+    DistanceKernel<Rows, Cols> kernel_; ///< vectorized full evaluation
+};
+
+template <std::size_t Rows, std::size_t Cols = Rows>
+using ManhattanDistance = TileDistance<Rows, Cols, ManhattanMetric>;
+
+template <std::size_t Rows, std::size_t Cols = Rows>
+using EuclideanDistance = TileDistance<Rows, Cols, EuclideanMetric>;
+
+template <std::size_t Rows, std::size_t Cols = Rows>
+using ChebyshevDistance = TileDistance<Rows, Cols, ChebyshevMetric>;
+
+/**
+* \brief Manhattan distance with linear conflicts, see linear_conflict_distance()
+*
+* \details Conflicts depend on whole lines, so every board is evaluated from scratch
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class LinearConflictDistance
+{
+public:
+    LinearConflictDistance() = delete;
+
+    explicit LinearConflictDistance(const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols>* = nullptr)
+        : goals_{ goal_cells(target) }
+    {}
+
+    float evaluate(const GameBoard<Rows, Cols> &board) const noexcept
+    {
+        return linear_conflict_distance(board, goals_);
+    }
+
+    float update(float, const GameBoard<Rows, Cols> &board, std::size_t) const noexcept
+    {
+        return evaluate(board);
+    }
+
+private:
+    GoalCells<Rows, Cols> goals_; ///< goal cell of every tile of the target
+};
+
+/**
+* \brief Walking distance, see walking_distance()
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class WalkingDistance
+{
+public:
+    WalkingDistance() = delete;
+
+    explicit WalkingDistance(const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols>* = nullptr)
+        : goals_{ goal_cells(target) }
+    {}
+
+    float evaluate(const GameBoard<Rows, Cols> &board) const noexcept
+    {
+        return walking_distance(board, goals_);
+    }
+
+    float update(float, const GameBoard<Rows, Cols> &board, std::size_t) const noexcept
+    {
+        return evaluate(board);
+    }
+
+private:
+    GoalCells<Rows, Cols> goals_; ///< goal cell of every tile of the target
+};
+
+/**
+* \brief Additive pattern databases
+*
+* \details Only the pattern of the moved tile is looked up after a move.
+* Manhattan distance is used if no database is given or it was built for another target.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class PatternDatabaseDistance
+{
+public:
+    PatternDatabaseDistance() = delete;
+
+    explicit PatternDatabaseDistance(const GameBoard<Rows, Cols> &target, const PatternDatabase<Rows, Cols> *database = nullptr)
+        : database_{ (database != nullptr && database->matches(target)) ? database : nullptr }, fallback_{ target }
+    {}
+
+    float evaluate(const GameBoard<Rows, Cols> &board) const noexcept
+    {
+        return (database_ != nullptr) ? database_->distance(board) : fallback_.evaluate(board);
+    }
+
+    float update(float distance, const GameBoard<Rows, Cols> &board, std::size_t previous_blank) const noexcept
+    {
+        return (database_ != nullptr) ? database_->update(distance, board, previous_blank) : fallback_.update(distance, board, previous_blank);
+    }
+
+private:
+    const PatternDatabase<Rows, Cols> *database_; ///< pattern databases, nullptr if not used
+    ManhattanDistance<Rows, Cols> fallback_; ///< distance used without databases
+};
+
+/**
+* \brief Carries heuristic policy type to the visitor of visit_distance()
+*/
+template <typename Distance>
+struct DistanceTag
+{
+    using type = Distance;
+};
+
+/**
+* \brief Calls the visitor with the policy of the given distance type
+*
+* \details Runtime choice of the heuristic is turned into a template argument once per search,
+* so the searchers themselves never dispatch on DistanceType
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param distance_type type of the distance
+* @param visitor generic callable taking DistanceTag
+*
+* @return Result of the visitor
+*/
+template <std::size_t Rows, std::size_t Cols, typename Visitor>
+decltype(auto) visit_distance(DistanceType distance_type, Visitor &&visitor)
+{
+    switch (distance_type)
+    {
+    case DistanceType::Euclidean:
+        return visitor(DistanceTag< EuclideanDistance<Rows, Cols> >{});
+
+    case DistanceType::Chebyshev:
+        return visitor(DistanceTag< ChebyshevDistance<Rows, Cols> >{});
+
+    case DistanceType::LinearConflict:
+        return visitor(DistanceTag< LinearConflictDistance<Rows, Cols> >{});
+
+    case DistanceType::WalkingDistance:
+        return visitor(DistanceTag< WalkingDistance<Rows, Cols> >{});
+
+    default:
+        return visitor(DistanceTag< ManhattanDistance<Rows, Cols> >{});
+    }
+}
+
+#endif // HEURISTIC_H_
@@ -0,0 +1,588 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LINE_DISTANCE_H_
+#define LINE_DISTANCE_H_
+
+#include "game_board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <type_traits>
+
+/*
+* Linear conflict and walking distance heuristics.
+* Both of them look at every row and column of the board separately,
+* their tables depend only on the length of the lines and are generated by constexpr functions.
+*/
+
+namespace
+{
+    /**
+    * \brief Returns power of the number
+    */
+    constexpr std::size_t power(std::size_t base, std::size_t exponent) noexcept
+    {
+        std::size_t result = 1;
+
+        for (std::size_t i = 0; i < exponent; i++)
+        {
+            result *= base;
+        }
+
+        return result;
+    }
+
+    /**
+    * \brief Counts extra moves caused by linear conflicts in a single line
+    *
+    * \details Line is encoded as a number in base Length + 1, digit of the cell is
+    * the target position within the line of the tile in it,
+    * or Length if the tile doesn't belong to the line, the first cell is the least significant digit.
+    * Tiles which have to leave the line to let the others pass are those not in the
+    * longest increasing subsequence, each of them costs two extra moves.
+    */
+    template <std::size_t Length>
+    constexpr std::uint8_t line_conflicts(std::size_t code)
+    {
+        std::array<std::size_t, Length> goals{};
+        std::array<std::size_t, Length> longest{};
+        std::size_t count = 0;
+        std::size_t increasing = 0;
+
+        // Collect goals of tiles which belong to the line
+        for (std::size_t i = 0; i < Length; i++, code /= Length + 1)
+        {
+            if (code % (Length + 1) != Length)
+            {
+                goals[count++] = code % (Length + 1);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            longest[i] = 1;
+
+            for (std::size_t j = 0; j < i; j++)
+            {
+                if (goals[j] < goals[i] && longest[j] + 1 > longest[i])
+                {
+                    longest[i] = longest[j] + 1;
+                }
+            }
+
+            if (longest[i] > increasing)
+            {
+                increasing = longest[i];
+            }
+        }
+
+        return static_cast<std::uint8_t>(2 * (count - increasing));
+    }
+
+    /**
+    * \brief Table of linear conflicts of every line of the given length
+    */
+    template <std::size_t Length>
+    struct ConflictTable
+    {
+        static constexpr std::size_t size = power(Length + 1, Length); ///< number of encoded lines
+
+        std::array<std::uint8_t, size> conflicts{};
+
+        constexpr ConflictTable()
+        {
+            for (std::size_t code = 0; code < size; code++)
+            {
+                conflicts[code] = line_conflicts<Length>(code);
+            }
+        }
+    };
+
+    /**
+    * \brief Table of walking distances
+    *
+    * \details State is Lines x Lines matrix, element (i, j) is the number of tiles in line i
+    * which belong to line j, blank tile isn't counted. Every line holds Width cells. Blank moves to the next line
+    * by swapping with any tile of it, so the state changes by moving one tile between lines.
+    * Table stores the number of such moves to the target state for every reachable state,
+    * one table for every target line of the blank.
+    *
+    * States are encoded as numbers in base Width + 1, the first element is the most significant digit,
+    * codes are kept sorted and looked up by binary search.
+    *
+    * @tparam Lines number of lines, rows of the board for vertical moves and columns for horizontal ones
+    * @tparam Width number of cells in every line
+    * @tparam States number of states if the table is built at compile time, 0 if it is built at run time
+    */
+    template <std::size_t Lines, std::size_t Width, std::size_t States = 0>
+    struct WalkingDistanceTable
+    {
+        template <typename Value>
+        using Storage = std::conditional_t<(States > 0), std::array<Value, States>, std::vector<Value>>;
+
+        using Matrix = std::array<std::uint8_t, Lines * Lines>;
+
+        static constexpr std::size_t base = Width + 1; ///< base of the state code
+        static constexpr std::uint8_t unvisited = 0xFF; ///< distance of states not reached yet
+
+        /**
+        * \brief Enumerates states in the ascending order of codes
+        *
+        * \details Column sums are fixed by the target, row sums are Width or Width - 1 for the line of the blank.
+        * Codes are appended to the vector when the table is built at run time,
+        * which also stops compilers from trying to build it at compile time.
+        *
+        * @return Number of enumerated states
+        */
+        template <typename Codes>
+        static constexpr std::size_t enumerate(Codes *codes, std::size_t blank_line)
+        {
+            Matrix matrix{};
+            std::array<std::size_t, Lines> column_left{};
+
+            for (std::size_t j = 0; j < Lines; j++)
+            {
+                column_left[j] = (j == blank_line) ? Width - 1 : Width;
+            }
+
+            std::size_t count = 0;
+            std::size_t cell = 0;
+
+            // Depth-first walk over elements of the matrix with explicit backtracking
+            while (true)
+            {
+                auto row = cell / Lines;
+                auto column = cell % Lines;
+                auto value = matrix[cell];
+                std::size_t row_sum = 0;
+
+                for (std::size_t j = row * Lines; j < cell; j++)
+                {
+                    row_sum += matrix[j];
+                }
+
+                auto valid = value <= column_left[column] && row_sum + value <= Width
+                    && (column != Lines - 1 || row_sum + value + 1 >= Width)
+                    && (row != Lines - 1 || value == column_left[column]);
+
+                if (valid && cell == Lines * Lines - 1)
+                {
+                    if constexpr (States == 0)
+                    {
+                        codes->push_back(encode(matrix));
+                    }
+                    else if (codes != nullptr)
+                    {
+                        (*codes)[count] = encode(matrix);
+                    }
+
+                    ++count;
+                }
+                else if (valid)
+                {
+                    // Go to the next element
+                    column_left[column] -= value;
+                    matrix[++cell] = 0;
+                    continue;
+                }
+
+                // Larger values don't fit either
+                if (value > column_left[column] || row_sum + value >= Width)
+                {
+                    matrix[cell] = Width;
+                }
+
+                // Try the next value, go back if every value was tried
+                while (matrix[cell] == Width)
+                {
+                    if (cell == 0)
+                    {
+                        return count;
+                    }
+
+                    matrix[cell--] = 0;
+                    column_left[cell % Lines] += matrix[cell];
+                }
+
+                ++matrix[cell];
+            }
+        }
+
+        static constexpr std::uint64_t encode(const Matrix &matrix)
+        {
+            std::uint64_t code = 0;
+
+            for (std::size_t i = 0; i < Lines * Lines; i++)
+            {
+                code = code * base + matrix[i];
+            }
+
+            return code;
+        }
+
+        static constexpr Matrix decode(std::uint64_t code)
+        {
+            Matrix matrix{};
+
+            for (std::size_t i = Lines * Lines; i-- > 0; code /= base)
+            {
+                matrix[i] = static_cast<std::uint8_t>(code % base);
+            }
+
+            return matrix;
+        }
+
+        std::size_t states{ States }; ///< number of states
+        std::array< Storage<std::uint64_t>, Lines > codes{}; ///< sorted codes of states
+        std::array< Storage<std::uint8_t>, Lines > distances{}; ///< walking distance of every state
+
+        constexpr WalkingDistanceTable()
+        {
+            for (std::size_t line = 0; line < Lines; line++)
+            {
+                states = enumerate(&codes[line], line);
+
+                if constexpr (States == 0)
+                {
+                    distances[line].resize(states);
+                }
+
+                search(line);
+            }
+        }
+
+        constexpr std::size_t find(std::size_t blank_line, std::uint64_t code) const
+        {
+            std::size_t first = 0;
+            std::size_t last = states;
+
+            while (last - first > 1)
+            {
+                auto middle = (first + last) / 2;
+
+                if (codes[blank_line][middle] <= code)
+                {
+                    first = middle;
+                }
+                else
+                {
+                    last = middle;
+                }
+            }
+
+            return first;
+        }
+
+        /**
+        * \brief Breadth-first search from the target state
+        */
+        constexpr void search(std::size_t blank_line)
+        {
+            auto queue = Storage<std::uint32_t>{};
+            std::size_t head = 0;
+            std::size_t tail = 0;
+
+            if constexpr (States == 0)
+            {
+                queue.resize(states);
+            }
+
+            for (auto &distance : distances[blank_line])
+            {
+                distance = unvisited;
+            }
+
+            Matrix target{};
+
+            for (std::size_t i = 0; i < Lines; i++)
+            {
+                target[i * Lines + i] = static_cast<std::uint8_t>((i == blank_line) ? Width - 1 : Width);
+            }
+
+            auto start = find(blank_line, encode(target));
+            distances[blank_line][start] = 0;
+            queue[tail++] = static_cast<std::uint32_t>(start);
+
+            while (head < tail)
+            {
+                auto index = queue[head++];
+                auto matrix = decode(codes[blank_line][index]);
+                std::size_t blank = 0;
+
+                // Line of the blank is the only line with Width - 1 tiles
+                for (std::size_t i = 0; i < Lines; i++)
+                {
+                    std::size_t sum = 0;
+
+                    for (std::size_t j = 0; j < Lines; j++)
+                    {
+                        sum += matrix[i * Lines + j];
+                    }
+
+                    if (sum < Width)
+                    {
+                        blank = i;
+                    }
+                }
+
+                for (std::size_t other : { blank - 1, blank + 1 })
+                {
+                    if (other >= Lines)
+                    {
+                        continue;
+                    }
+
+                    // Move tile of every kind from the neighbour line to the line of the blank
+                    for (std::size_t j = 0; j < Lines; j++)
+                    {
+                        if (matrix[other * Lines + j] == 0)
+                        {
+                            continue;
+                        }
+
+                        --matrix[other * Lines + j];
+                        ++matrix[blank * Lines + j];
+
+                        auto child = find(blank_line, encode(matrix));
+
+                        if (distances[blank_line][child] == unvisited)
+                        {
+                            distances[blank_line][child] = static_cast<std::uint8_t>(distances[blank_line][index] + 1);
+                            queue[tail++] = static_cast<std::uint32_t>(child);
+                        }
+
+                        ++matrix[other * Lines + j];
+                        --matrix[blank * Lines + j];
+                    }
+                }
+            }
+        }
+    };
+
+    /**
+    * \brief Returns conflict table of lines of the given length
+    *
+    * \details Tables of lines up to 5 cells are built at compile time,
+    * larger ones are built on first use
+    */
+    template <std::size_t Length>
+    const std::uint8_t* conflict_table()
+    {
+        if constexpr (power(Length + 1, Length) <= 10000)
+        {
+            static constexpr auto table = ConflictTable<Length>{};
+            return table.conflicts.data();
+        }
+        else
+        {
+            static const auto table = [] {
+                auto conflicts = std::vector<std::uint8_t>(power(Length + 1, Length));
+
+                for (std::size_t code = 0; code < conflicts.size(); code++)
+                {
+                    conflicts[code] = line_conflicts<Length>(code);
+                }
+
+                return conflicts;
+            }();
+
+            return table.data();
+        }
+    }
+
+    /**
+    * \brief Returns walking distance table of the given number and width of lines
+    *
+    * \details Tables of boards up to 3x3 are built at compile time, 4x4 tables exceed the default
+    * constexpr evaluation limits of compilers, so they are built by the same code on first use
+    */
+    template <std::size_t Lines, std::size_t Width>
+    const auto& walking_distance_table()
+    {
+        if constexpr (Lines <= 3 && Width <= 3)
+        {
+            constexpr auto states = WalkingDistanceTable<Lines, Width, 1>::enumerate(static_cast< std::array<std::uint64_t, 1>* >(nullptr), 0);
+
+            static constexpr auto table = WalkingDistanceTable<Lines, Width, states>{};
+            return table;
+        }
+        else
+        {
+            static const auto table = WalkingDistanceTable<Lines, Width>{};
+            return table;
+        }
+    }
+
+    /**
+    * \brief Target cell of every tile id
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    using GoalCells = std::array<std::uint8_t, (std::size_t{ 1 } << GameBoard<Rows, Cols>::Key::bits)>;
+
+    /**
+    * \brief Returns goal cell of every tile
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    GoalCells<Rows, Cols> goal_cells(const GameBoard<Rows, Cols> &target) noexcept
+    {
+        auto goals = GoalCells<Rows, Cols>{};
+
+        for (std::size_t cell = 0; cell < Rows * Cols; cell++)
+        {
+            goals[target.tile(cell)] = static_cast<std::uint8_t>(cell);
+        }
+
+        return goals;
+    }
+}
+
+/**
+* \brief Computes Manhattan distance with linear conflicts
+*
+* \details Two tiles in their target line but in the wrong order
+* need two extra moves to pass each other.
+* Rows and columns of rectangular boards differ in length, so they use separate conflict tables.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param begin board from which distance is computed
+* @param goals goal cell of every tile, see goal_cells()
+*
+* @return Manhattan distance plus linear conflicts of all rows and columns
+*/
+template <std::size_t Rows, std::size_t Cols>
+float linear_conflict_distance(const GameBoard<Rows, Cols> &begin, const GoalCells<Rows, Cols> &goals) noexcept
+{
+    const auto *row_conflicts = conflict_table<Cols>();
+    const auto *column_conflicts = conflict_table<Rows>();
+
+    std::size_t distance = 0;
+
+    for (std::size_t row = 0; row < Rows; row++)
+    {
+        std::size_t code = 0;
+
+        for (std::size_t col = Cols; col-- > 0; )
+        {
+            auto tile = begin.tile(row * Cols + col);
+            auto goal = goals[tile];
+
+            code = code * (Cols + 1) + ((tile != 0 && goal / Cols == row) ? goal % Cols : Cols);
+
+            if (tile != 0)
+            {
+                auto rows = static_cast<int>(row) - static_cast<int>(goal / Cols);
+                auto cols = static_cast<int>(col) - static_cast<int>(goal % Cols);
+
+                distance += static_cast<std::size_t>((rows < 0 ? -rows : rows) + (cols < 0 ? -cols : cols));
+            }
+        }
+
+        distance += row_conflicts[code];
+    }
+
+    for (std::size_t col = 0; col < Cols; col++)
+    {
+        std::size_t code = 0;
+
+        for (std::size_t row = Rows; row-- > 0; )
+        {
+            auto tile = begin.tile(row * Cols + col);
+            auto goal = goals[tile];
+
+            code = code * (Rows + 1) + ((tile != 0 && goal % Cols == col) ? goal / Cols : Rows);
+        }
+
+        distance += column_conflicts[code];
+    }
+
+    return static_cast<float>(distance);
+}
+
+template <std::size_t Rows, std::size_t Cols>
+float linear_conflict_distance(const GameBoard<Rows, Cols> &begin, const GameBoard<Rows, Cols> &end) noexcept
+{
+    return linear_conflict_distance(begin, goal_cells(end));
+}
+
+/**
+* \brief Computes walking distance
+*
+* \details Sum of the number of vertical moves needed to bring every tile to its target row
+* and the number of horizontal moves needed to bring it to its target column,
+* where tiles are only told apart by their target row (or column).
+* Vertical moves use the table of Rows lines of Cols cells, horizontal ones the table of Cols lines of Rows cells.
+* Tables are too large for boards with a side longer than 4, linear conflict distance is used there.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param begin board from which distance is computed
+* @param goals goal cell of every tile, see goal_cells()
+*
+* @return Walking distance from the board to the target board
+*/
+template <std::size_t Rows, std::size_t Cols>
+float walking_distance(const GameBoard<Rows, Cols> &begin, const GoalCells<Rows, Cols> &goals) noexcept
+{
+    if constexpr (Rows > 4 || Cols > 4)
+    {
+        return linear_conflict_distance(begin, goals);
+    }
+    else
+    {
+        const auto &vertical_table = walking_distance_table<Rows, Cols>();
+        const auto &horizontal_table = walking_distance_table<Cols, Rows>();
+
+        using VerticalTable = std::decay_t<decltype(vertical_table)>;
+        using HorizontalTable = std::decay_t<decltype(horizontal_table)>;
+
+        const auto blank = static_cast<std::size_t>(goals[0]);
+
+        typename VerticalTable::Matrix rows{};
+        typename HorizontalTable::Matrix columns{};
+
+        for (std::size_t cell = 0; cell < Rows * Cols; cell++)
+        {
+            auto tile = begin.tile(cell);
+
+            if (tile != 0)
+            {
+                ++rows[cell / Cols * Rows + goals[tile] / Cols];
+                ++columns[cell % Cols * Cols + goals[tile] % Cols];
+            }
+        }
+
+        auto vertical = vertical_table.distances[blank / Cols][vertical_table.find(blank / Cols, VerticalTable::encode(rows))];
+        auto horizontal = horizontal_table.distances[blank % Cols][horizontal_table.find(blank % Cols, HorizontalTable::encode(columns))];
+
+        return static_cast<float>(vertical + horizontal);
+    }
+}
+
+template <std::size_t Rows, std::size_t Cols>
+float walking_distance(const GameBoard<Rows, Cols> &begin, const GameBoard<Rows, Cols> &end) noexcept
+{
+    return walking_distance(begin, goal_cells(end));
+}
+
+#endif // LINE_DISTANCE_H_
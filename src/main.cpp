@@ -17,6 +17,19 @@
 */
 
 #include "eight_puzzle_solver.h"
+#include "solution_cache.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 constexpr auto initial_board = std::array< std::array< char, 3 >, 3 >{ {
     {'1', '8', '2'},
@@ -30,24 +43,687 @@ constexpr auto target_board = std::array< std::array< char, 3 >, 3 >{ {
 } };
 
 
-int main()
+namespace
 {
-    std::cout << "Breadth first search path:";
-    breadth_first_search(GameBoard<3>(initial_board), GameBoard<3>(target_board)).show_path();
+    enum class Algorithm
+    {
+        BFS, ///< breadth_first_search()
+        DFS, ///< depth_first_search()
+        AStar, ///< A_star() with Manhattan distance
+        Anytime, ///< anytime_A_star() with linear conflicts and the deadline
+        Beam, ///< beam_search() with linear conflicts and the width
+        External ///< external_breadth_first_search() in the work directory
+    };
+
+    struct Options
+    {
+        std::size_t rows{ 3 }; // number of rows of the boards
+        std::size_t cols{ 3 }; // number of columns of the boards
+        Algorithm algorithm{ Algorithm::AStar }; // search used for every board
+        std::size_t threads{ std::thread::hardware_concurrency() }; // number of workers
+        std::string input{ "-" }; // file with boards, "-" for standard input
+        std::string output{ "-" }; // file for results, "-" for standard output
+        std::string target{}; // target board, tiles in order followed by the blank if empty
+        std::string directory{}; // work directory of the external search
+        std::size_t memory{ 256 }; // megabytes of boards sorted in memory by the external search
+        bool sweep{ false }; // find every board reachable from the target instead of solving the input
+        std::string cache{}; // snapshot of the solution cache loaded before and saved after the batch
+        std::size_t cache_size{ 1 << 16 }; // maximum number of cached solutions
+        bool json{ false }; // write every result as a JSON object instead of a line of text
+        std::size_t deadline{ 1000 }; // milliseconds of every anytime search
+        std::size_t width{ 1000 }; // number of boards kept in every level of beam search
+        std::optional<DistanceType> heuristic{}; // heuristic of informed searches, every search has its own default if empty
+        bool pattern_database{ false }; // informed searches use pattern databases of the database file instead of the heuristic
+        std::string database{}; // file of pattern databases, built and saved there if it doesn't exist
+    };
+
+    void show_usage()
+    {
+        std::cerr << "Usage: puzzle [--size N|RxC] [--algorithm bfs|dfs|astar|anytime|beam|external]\n"
+                     "              [--threads N] [--deadline MS] [--width N]\n"
+                     "              [--heuristic manhattan|linear|walking|pdb] [--pdb FILE]\n"
+                     "              [--work-dir DIR] [--memory MB] [--sweep]\n"
+                     "              [--cache FILE] [--cache-size N] [--format text|json]\n"
+                     "              [--target BOARD] [--output FILE] [FILE|-]\n"
+                     "Solves every board of the input, one board per line.\n"
+                     "Boards are 2x2, 2x3, 2x4, 3x3, 3x4, 4x4, 4x5, 5x5, 6x6 or 7x7, N stands for NxN.\n"
+                     "Board lists tiles row by row either as numbers separated by spaces\n"
+                     "or as one character per tile, '0' or '_' stands for the blank.\n"
+                     "Every result line holds length, moves of the blank, nodes and time in ms,\n"
+                     "length is -1 if the board is unsolvable.\n"
+                     "--format json writes one object per line with found, length, moves, nodes, seconds,\n"
+                     "bound, the ratio by which the solution may be longer than the shortest one, and stats of the search.\n"
+                     "anytime returns the best solution found in --deadline milliseconds, 1000 by default.\n"
+                     "beam keeps --width boards of every level, 1000 by default, and solves the largest boards\n"
+                     "with solutions which aren't the shortest.\n"
+                     "--heuristic is used by astar, anytime and beam, Manhattan distance is the default of astar,\n"
+                     "linear conflicts of the others. pdb takes additive pattern databases from --pdb FILE,\n"
+                     "the file is built for the target and saved when it doesn't exist yet.\n"
+                     "external keeps levels of breadth first search from the target in --work-dir,\n"
+                     "they are reused by later runs and an interrupted run resumes from the last level.\n"
+                     "--sweep finds every board reachable from the target and writes the number of boards\n"
+                     "at every distance instead of solving the input.\n"
+                     "Shortest solutions are cached, so repeated boards are answered without a search,\n"
+                     "--cache keeps the cache in FILE between runs.\n"
+                     "Without arguments the demo is run.\n";
+    }
+
+    bool parse_number(const char *text, std::size_t &number)
+    {
+        const auto value = std::string(text);
+
+        if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+
+        number = std::stoul(value);
+
+        return true;
+    }
+
+    /**
+    * \brief Reads shape of the boards written as N or RxC
+    */
+    bool parse_shape(const char *text, Options &options)
+    {
+        const auto value = std::string(text);
+        const auto separator = value.find('x');
+
+        if (separator == std::string::npos)
+        {
+            return parse_number(text, options.rows) && parse_number(text, options.cols);
+        }
+
+        return parse_number(value.substr(0, separator).c_str(), options.rows)
+            && parse_number(value.substr(separator + 1).c_str(), options.cols);
+    }
+
+    bool parse_options(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const auto argument = std::string(argv[i]);
+            const bool has_value = i + 1 < argc;
+
+            if (argument == "--size" && has_value)
+            {
+                if (!parse_shape(argv[++i], options))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--threads" && has_value)
+            {
+                if (!parse_number(argv[++i], options.threads))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--output" && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else if (argument == "--target" && has_value)
+            {
+                options.target = argv[++i];
+            }
+            else if (argument == "--deadline" && has_value)
+            {
+                if (!parse_number(argv[++i], options.deadline))
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--width" && has_value)
+            {
+                if (!parse_number(argv[++i], options.width) || options.width == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--heuristic" && has_value)
+            {
+                const auto name = std::string(argv[++i]);
+
+                // The last choice wins
+                options.pattern_database = (name == "pdb");
+                options.heuristic.reset();
+
+                if (name == "manhattan")
+                {
+                    options.heuristic = DistanceType::Manhattan;
+                }
+                else if (name == "linear")
+                {
+                    options.heuristic = DistanceType::LinearConflict;
+                }
+                else if (name == "walking")
+                {
+                    options.heuristic = DistanceType::WalkingDistance;
+                }
+                else if (name != "pdb")
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--pdb" && has_value)
+            {
+                options.database = argv[++i];
+            }
+            else if (argument == "--work-dir" && has_value)
+            {
+                options.directory = argv[++i];
+            }
+            else if (argument == "--memory" && has_value)
+            {
+                if (!parse_number(argv[++i], options.memory) || options.memory == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--cache" && has_value)
+            {
+                options.cache = argv[++i];
+            }
+            else if (argument == "--cache-size" && has_value)
+            {
+                if (!parse_number(argv[++i], options.cache_size) || options.cache_size == 0)
+                {
+                    return false;
+                }
+            }
+            else if (argument == "--format" && has_value)
+            {
+                const auto format = std::string(argv[++i]);
+
+                if (format != "text" && format != "json")
+                {
+                    return false;
+                }
+
+                options.json = (format == "json");
+            }
+            else if (argument == "--sweep")
+            {
+                options.sweep = true;
+            }
+            else if (argument == "--algorithm" && has_value)
+            {
+                const auto name = std::string(argv[++i]);
+
+                if (name == "bfs")
+                {
+                    options.algorithm = Algorithm::BFS;
+                }
+                else if (name == "dfs")
+                {
+                    options.algorithm = Algorithm::DFS;
+                }
+                else if (name == "astar")
+                {
+                    options.algorithm = Algorithm::AStar;
+                }
+                else if (name == "anytime")
+                {
+                    options.algorithm = Algorithm::Anytime;
+                }
+                else if (name == "beam")
+                {
+                    options.algorithm = Algorithm::Beam;
+                }
+                else if (name == "external")
+                {
+                    options.algorithm = Algorithm::External;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if (argument.size() > 1 && argument[0] == '-' && argument != "-")
+            {
+                return false;
+            }
+            else
+            {
+                options.input = argument;
+            }
+        }
+
+        // Pattern databases are loaded only from a file
+        if (!options.database.empty() && !options.heuristic)
+        {
+            options.pattern_database = true;
+        }
+        else if (options.pattern_database && options.database.empty())
+        {
+            return false;
+        }
+
+        // External search and the sweep keep their levels in the work directory
+        return !options.directory.empty() || (options.algorithm != Algorithm::External && !options.sweep);
+    }
+
+    /**
+    * \brief Reads board from the line
+    *
+    * \details Tiles are numbers separated by spaces or commas, or single characters without separators.
+    * Every number from 0 to Rows*Cols-1 has to appear exactly once, 0 is the blank.
+    *
+    * @return True if the line holds valid board, false otherwise
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    bool parse_board(const std::string &line, GameBoard<Rows, Cols> &board)
+    {
+        constexpr std::size_t cells = Rows * Cols;
+
+        auto text = line;
+        std::replace(text.begin(), text.end(), ',', ' ');
+        std::replace(text.begin(), text.end(), '_', '0');
+
+        auto tokens = std::vector<std::string>{};
+        auto tiles = std::vector<std::size_t>{};
+        auto stream = std::istringstream(text);
+
+        for (std::string token; stream >> token; )
+        {
+            tokens.push_back(token);
+        }
+
+        // Tiles written without separators
+        if (tokens.size() == 1 && cells > 1)
+        {
+            for (char label : tokens.front())
+            {
+                tiles.push_back((label == '0') ? 0 : tile_id(label));
+            }
+        }
+        else
+        {
+            for (const std::string &token : tokens)
+            {
+                if (token.size() > 3 || token.find_first_not_of("0123456789") != std::string::npos)
+                {
+                    return false;
+                }
+
+                tiles.push_back(std::stoul(token));
+            }
+        }
+
+        if (tiles.size() != cells)
+        {
+            return false;
+        }
+
+        auto seen = std::vector<bool>(cells);
+        auto key = typename GameBoard<Rows, Cols>::Key{};
+
+        for (std::size_t cell = 0; cell < cells; cell++)
+        {
+            if (tiles[cell] >= cells || seen[tiles[cell]])
+            {
+                return false;
+            }
+
+            seen[tiles[cell]] = true;
+            key.set(cell, static_cast<std::uint8_t>(tiles[cell]));
+        }
+
+        board = GameBoard<Rows, Cols>(key);
+
+        return true;
+    }
+
+    template <std::size_t Rows, std::size_t Cols>
+    std::string solve(const std::string &line, const GameBoard<Rows, Cols> &target, const Options &options, SolutionCache<Rows, Cols> &cache,
+        const PatternDatabase<Rows, Cols> &database)
+    {
+        auto initial = GameBoard<Rows, Cols>{};
+
+        if (!parse_board(line, initial))
+        {
+            return options.json ? "{\"invalid\": true}" : "invalid";
+        }
+
+        const auto heuristic = options.heuristic.value_or(options.algorithm == Algorithm::AStar ? DistanceType::Manhattan : DistanceType::LinearConflict);
+        const auto budget = SearchBudget{ std::chrono::milliseconds(options.deadline) };
+        const bool has_database = options.pattern_database;
+
+        // Statistics stay zero when the cache answers the query
+        auto stats = SearchStats{};
+        const auto start = std::chrono::steady_clock::now();
+        auto solution = cache.solve(initial, target, [&]
+        {
+            switch (options.algorithm)
+            {
+            case Algorithm::BFS:
+                return breadth_first_search(initial, target, &stats);
+
+            case Algorithm::DFS:
+                return depth_first_search(initial, target, unlimited_depth, &stats);
+
+            case Algorithm::Anytime:
+                return has_database ? anytime_A_star(initial, target, database, budget, 3.0f, &stats)
+                    : anytime_A_star(initial, target, heuristic, budget, 3.0f, &stats);
+
+            // Boards of the batch already keep every thread busy
+            case Algorithm::Beam:
+                return has_database ? beam_search(initial, target, database, options.width, 1, beam_depth_limit, &stats)
+                    : beam_search(initial, target, heuristic, options.width, 1, beam_depth_limit, &stats);
+
+            case Algorithm::External:
+                return external_breadth_first_search(initial, target, options.directory, options.memory << 20, &stats);
+
+            default:
+                return has_database ? A_star(initial, target, database, &stats) : A_star(initial, target, heuristic, &stats);
+            }
+        });
+
+        solution.set_seconds(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        solution.set_stats(stats);
+
+        auto result = OutputBuffer{};
+
+        if (options.json)
+        {
+            write_json(result, solution);
+        }
+        else
+        {
+            write_text(result, solution);
+            result << ' ' << solution.nodes() << ' ' << solution.seconds() * 1000.0;
+        }
+
+        return result.release();
+    }
+
+    /**
+    * \brief Finds distance of every board reachable from the target
+    *
+    * \details Writes depth and number of boards at that depth, one level per line.
+    * Boards of the deepest level are the hardest instances, their file is reported on the standard error.
+    *
+    * @return Exit code of the program
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    int run_sweep(const Options &options, const GameBoard<Rows, Cols> &target, std::ostream &output)
+    {
+        auto search = ExternalBreadthFirstSearch<Rows, Cols>(target, options.directory, options.memory << 20);
+
+        if (!search.run())
+        {
+            std::cerr << "Can't use work directory " << options.directory << '\n';
+            return 1;
+        }
+
+        const auto &sizes = search.level_sizes();
+
+        // Last level is empty, it only marks the end of the search
+        for (std::size_t depth = 0; depth + 1 < sizes.size(); depth++)
+        {
+            output << depth << ' ' << sizes[depth] << '\n';
+        }
+
+        std::cerr << "Hardest boards are in " << search.level_path(sizes.size() - 2) << '\n';
+        output.flush();
+
+        return output ? 0 : 1;
+    }
+
+    /**
+    * \brief Loads pattern databases of the target, builds and saves them if the file doesn't exist
+    *
+    * \details Tiles are split into patterns of at most 6 tiles, larger ones take many times longer to build
+    *
+    * @return True if the databases are ready, false otherwise
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    bool load_database(const std::string &path, const GameBoard<Rows, Cols> &target, PatternDatabase<Rows, Cols> &database)
+    {
+        if (std::ifstream(path))
+        {
+            database = PatternDatabase<Rows, Cols>::load(path);
+
+            if (!database.matches(target))
+            {
+                std::cerr << "Pattern databases in " << path << " are malformed or built for another target\n";
+                return false;
+            }
 
-    std::cout << "Depth first search path:";
-    depth_first_search(GameBoard<3>(initial_board), GameBoard<3>(target_board)).show_path();
+            return true;
+        }
 
-    std::cout << "A* search path (Manhattan):\n";
-    A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Manhattan).show_path();
+        const auto largest = std::min<std::size_t>(PatternDatabase<Rows, Cols>::largest_pattern(), 6);
+        auto sizes = std::vector<std::size_t>((Rows * Cols - 1 + largest - 1) / largest, largest);
 
-    std::cout << "A* search path (Euclidean):\n";
-    A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Euclidean).show_path();
+        std::cerr << "Building pattern databases of " << largest << " tiles into " << path << '\n';
+        database = PatternDatabase<Rows, Cols>::build(target, PatternDatabase<Rows, Cols>::partition(target, sizes));
+
+        if (!database.save(path))
+        {
+            std::cerr << "Can't write pattern databases " << path << '\n';
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+    * \brief Solves every board of the input on the thread pool
+    *
+    * \details Results are written in the order of the input as soon as all earlier ones are ready
+    *
+    * @return Exit code of the program
+    */
+    template <std::size_t Rows, std::size_t Cols>
+    int run_batch(const Options &options, std::istream &input, std::ostream &output)
+    {
+        auto target = GameBoard<Rows, Cols>{};
+        auto target_line = options.target;
+
+        // Tiles in order followed by the blank
+        if (target_line.empty())
+        {
+            for (std::size_t tile = 1; tile < Rows * Cols; tile++)
+            {
+                target_line += std::to_string(tile) + ' ';
+            }
+
+            target_line += '0';
+        }
+
+        if (!parse_board(target_line, target))
+        {
+            std::cerr << "Invalid target board\n";
+            return 1;
+        }
+
+        if (options.sweep)
+        {
+            return run_sweep(options, target, output);
+        }
+
+        auto lines = std::vector<std::string>{};
+
+        for (std::string line; std::getline(input, line); )
+        {
+            if (line.find_first_not_of(" \t\r") != std::string::npos)
+            {
+                lines.push_back(line);
+            }
+        }
+
+        auto database = PatternDatabase<Rows, Cols>{};
+
+        if (options.pattern_database && !load_database(options.database, target, database))
+        {
+            return 1;
+        }
+
+        auto cache = SolutionCache<Rows, Cols>(options.cache_size);
+
+        // Missing snapshot is fine for the first run
+        if (!options.cache.empty() && std::ifstream(options.cache) && !cache.load(options.cache))
+        {
+            std::cerr << "Ignoring malformed cache " << options.cache << '\n';
+        }
+
+        auto results = std::vector<std::string>(lines.size());
+        auto is_ready = std::vector<bool>(lines.size());
+        std::mutex mutex;
+        std::condition_variable ready;
+
+        // Levels of the external search are written to one directory, so boards are solved one by one
+        ThreadPool pool(options.algorithm == Algorithm::External ? 1 : options.threads);
+
+        for (std::size_t i = 0; i < lines.size(); i++)
+        {
+            pool.submit([&, i]
+            {
+                auto result = solve<Rows, Cols>(lines[i], target, options, cache, database);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                results[i] = std::move(result);
+                is_ready[i] = true;
+                ready.notify_one();
+            });
+        }
+
+        auto buffer = OutputBuffer(output);
+
+        for (std::size_t i = 0; i < lines.size(); i++)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&] { return is_ready[i]; });
+
+            buffer << results[i] << '\n';
+            results[i] = std::string{};
+        }
+
+        pool.wait();
+
+        if (!buffer.flush())
+        {
+            return 1;
+        }
+
+        if (!options.cache.empty() && !cache.save(options.cache))
+        {
+            std::cerr << "Can't write cache " << options.cache << '\n';
+            return 1;
+        }
+
+        return output ? 0 : 1;
+    }
+
+    int run_batch(const Options &options)
+    {
+        auto file_input = std::ifstream{};
+        auto file_output = std::ofstream{};
+
+        if (options.input != "-")
+        {
+            file_input.open(options.input);
+
+            if (!file_input)
+            {
+                std::cerr << "Can't open " << options.input << '\n';
+                return 1;
+            }
+        }
+
+        if (options.output != "-")
+        {
+            file_output.open(options.output, std::ios::trunc);
+
+            if (!file_output)
+            {
+                std::cerr << "Can't open " << options.output << '\n';
+                return 1;
+            }
+        }
+
+        auto &input = (options.input != "-") ? static_cast<std::istream&>(file_input) : std::cin;
+        auto &output = (options.output != "-") ? static_cast<std::ostream&>(file_output) : std::cout;
+
+        // Every shape instantiates all searches, so only the common ones are compiled in
+        switch ((options.rows < 10 && options.cols < 10) ? options.rows * 10 + options.cols : 0)
+        {
+        case 22:
+            return run_batch<2, 2>(options, input, output);
+
+        case 23:
+            return run_batch<2, 3>(options, input, output);
+
+        case 24:
+            return run_batch<2, 4>(options, input, output);
+
+        case 33:
+            return run_batch<3, 3>(options, input, output);
+
+        case 34:
+            return run_batch<3, 4>(options, input, output);
+
+        case 44:
+            return run_batch<4, 4>(options, input, output);
+
+        case 45:
+            return run_batch<4, 5>(options, input, output);
+
+        case 55:
+            return run_batch<5, 5>(options, input, output);
+
+        case 66:
+            return run_batch<6, 6>(options, input, output);
+
+        case 77:
+            return run_batch<7, 7>(options, input, output);
+
+        default:
+            std::cerr << "Board shape " << options.rows << 'x' << options.cols << " isn't supported\n";
+            return 1;
+        }
+    }
+
+    void run_demo()
+    {
+        std::cout << "Breadth first search path:";
+        breadth_first_search(GameBoard<3>(initial_board), GameBoard<3>(target_board)).show_path();
+
+        std::cout << "Depth first search path:";
+        depth_first_search(GameBoard<3>(initial_board), GameBoard<3>(target_board)).show_path();
+
+        std::cout << "A* search path (Manhattan):\n";
+        A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Manhattan).show_path();
+
+        std::cout << "A* search path (Euclidean):\n";
+        A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Euclidean).show_path();
+
+        std::cout << "A* search path (Chebyshev):\n";
+        A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Chebyshev).show_path();
+
+        system("pause");
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        run_demo();
+        return 0;
+    }
 
-    std::cout << "A* search path (Chebyshev):\n";
-    A_star(GameBoard<3>(initial_board), GameBoard<3>(target_board), DistanceType::Chebyshev).show_path();
+    auto options = Options{};
 
-    system("pause");
+    if (!parse_options(argc, argv, options))
+    {
+        show_usage();
+        return 1;
+    }
 
-    return 0;
+    return run_batch(options);
 }
@@ -0,0 +1,197 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+* \brief Read-only memory-mapped file
+*
+* \details Pages of the file are shared through the page cache,
+* so every process which maps the same file uses a single copy of it
+*/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &path)
+    {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file_ == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER size{};
+
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+        {
+            close();
+            return;
+        }
+
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping_ == nullptr)
+        {
+            close();
+            return;
+        }
+
+        data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        auto descriptor = ::open(path.c_str(), O_RDONLY);
+
+        if (descriptor < 0)
+        {
+            return;
+        }
+
+        struct stat status{};
+
+        if (::fstat(descriptor, &status) == 0 && status.st_size > 0)
+        {
+            auto address = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+
+            if (address != MAP_FAILED)
+            {
+                data_ = static_cast<const std::uint8_t*>(address);
+                size_ = static_cast<std::size_t>(status.st_size);
+            }
+        }
+
+        // Mapping stays valid after the descriptor is closed
+        ::close(descriptor);
+#endif
+
+        if (data_ == nullptr)
+        {
+            close();
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            swap(other);
+        }
+
+        return *this;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    bool is_open() const noexcept
+    {
+        return data_ != nullptr;
+    }
+
+    const std::uint8_t* data() const noexcept
+    {
+        return data_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+private:
+    const std::uint8_t *data_{ nullptr }; ///< beginning of the mapped file
+    std::size_t size_{ 0 }; ///< size of the mapped file in bytes
+
+#ifdef _WIN32
+    HANDLE file_{ INVALID_HANDLE_VALUE }; ///< handle of the opened file
+    HANDLE mapping_{ nullptr }; ///< handle of the file mapping
+#endif
+
+    void swap(MappedFile &other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#endif
+    }
+
+    void close() noexcept
+    {
+#ifdef _WIN32
+        if (data_ != nullptr)
+        {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr)
+        {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file_);
+        }
+
+        file_ = INVALID_HANDLE_VALUE;
+        mapping_ = nullptr;
+#else
+        if (data_ != nullptr)
+        {
+            ::munmap(const_cast<std::uint8_t*>(data_), size_);
+        }
+#endif
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+};
+
+#endif // MAPPED_FILE_H_
@@ -0,0 +1,394 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MOVE_ORACLE_H_
+#define MOVE_ORACLE_H_
+
+#include "game_board.h"
+#include "permutation.h"
+#include "solution.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <utility>
+
+/**
+* \brief Table of distances to the target for every board of a small puzzle
+*
+* \details Distances are found by retrograde breadth-first search from the target
+* and stored in 4 bits per board indexed by permutation rank, 181 KB for the 8-puzzle.
+* Nibble keeps the distance modulo 15, which is enough to tell a neighbour one move closer
+* to the target from a neighbour one move farther; 0xF marks boards which can't reach the target.
+* Optimal path is then restored by table lookups only, in at most the largest distance of the table steps.
+*
+* File layout (native byte order):
+* "NMOR", version, number of rows, number of columns, packed target board, number of entries,
+* largest distance, then entries starting at 64-byte aligned offset.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class MoveOracle
+{
+    static_assert(Rows * Cols <= 9, "Table of every board is too large for boards with more than 9 cells");
+
+public:
+    static constexpr std::uint32_t version = 3; ///< version of the file format
+    static constexpr std::uint8_t unreachable = 0xF; ///< entry of boards which can't reach the target
+
+    MoveOracle() = default;
+
+    MoveOracle(const MoveOracle&) = delete;
+    MoveOracle& operator=(const MoveOracle&) = delete;
+
+    MoveOracle(MoveOracle&&) = default;
+    MoveOracle& operator=(MoveOracle&&) = default;
+
+    static MoveOracle build(const GameBoard<Rows, Cols> &target);
+    static MoveOracle load(const std::string &path);
+
+    bool save(const std::string &path) const;
+
+    /**
+    * \brief Checks whether the table is built or loaded
+    */
+    bool is_init() const noexcept
+    {
+        return entries_ != nullptr;
+    }
+
+    /**
+    * \brief Checks whether the table was built for the given target
+    */
+    bool matches(const GameBoard<Rows, Cols> &target) const noexcept
+    {
+        return is_init() && target.key() == target_;
+    }
+
+    /**
+    * \brief Returns distance of the board to the target modulo 15, unreachable if there is no path
+    */
+    std::uint8_t distance(const GameBoard<Rows, Cols> &board) const noexcept
+    {
+        return entry(index_.rank(board));
+    }
+
+    Solution<Rows, Cols> solve(const GameBoard<Rows, Cols> &initial) const;
+
+private:
+    static constexpr std::uint64_t boards_ = PermutationIndex<Rows, Cols>::size(); ///< number of entries
+    static constexpr std::size_t bytes_ = static_cast<std::size_t>((boards_ + 1) / 2); ///< size of the table
+    static constexpr char magic_[4] = { 'N', 'M', 'O', 'R' }; ///< first bytes of the file
+
+    typename GameBoard<Rows, Cols>::Key target_{}; ///< target board
+    std::uint32_t max_distance_{ 0 }; ///< distance of the farthest board from the target
+    PermutationIndex<Rows, Cols> index_{ GameBoard<Rows, Cols>{} }; ///< ranking of boards relative to the target
+    const std::uint8_t *entries_{ nullptr }; ///< two entries per byte, lower nibble first
+
+    std::vector<std::uint8_t> storage_{}; ///< entries if the table was built in memory
+    MappedFile file_{}; ///< entries if the table was loaded from file
+
+    std::uint8_t entry(std::uint64_t rank) const noexcept
+    {
+        return (entries_[rank / 2] >> (rank % 2 * 4)) & 0xF;
+    }
+};
+
+/**
+* \brief Builds table for the given target
+*
+* \details Every board of the next level is found from the boards of the current level,
+* the table itself marks visited boards
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param target target board
+*
+* @return Built table
+*/
+template <std::size_t Rows, std::size_t Cols>
+MoveOracle<Rows, Cols> MoveOracle<Rows, Cols>::build(const GameBoard<Rows, Cols> &target)
+{
+    auto oracle = MoveOracle{};
+    oracle.target_ = target.key();
+    oracle.index_ = PermutationIndex<Rows, Cols>(target);
+    oracle.storage_.assign(bytes_, 0xFF);
+
+    auto &storage = oracle.storage_;
+    const auto &index = oracle.index_;
+
+    auto set = [&storage](std::uint64_t rank, std::uint8_t distance)
+    {
+        auto &byte = storage[static_cast<std::size_t>(rank / 2)];
+        auto shift = rank % 2 * 4;
+
+        byte = static_cast<std::uint8_t>((byte & ~(0xF << shift)) | (distance << shift));
+    };
+
+    auto is_visited = [&storage](std::uint64_t rank)
+    {
+        return ((storage[static_cast<std::size_t>(rank / 2)] >> (rank % 2 * 4)) & 0xF) != unreachable;
+    };
+
+    auto current_level = std::vector<std::uint32_t>{ static_cast<std::uint32_t>(index.rank(target)) };
+    auto next_level = std::vector<std::uint32_t>{};
+    std::uint8_t distance = 0;
+    std::uint32_t depth = 0;
+
+    set(current_level.front(), distance);
+
+    while (!current_level.empty())
+    {
+        distance = static_cast<std::uint8_t>((distance + 1) % unreachable);
+
+        for (std::uint32_t rank : current_level)
+        {
+            const auto current = index.unrank(rank);
+
+            for (Direction direction : { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT })
+            {
+                auto next = current.move(direction);
+
+                if (!next.is_init())
+                {
+                    continue;
+                }
+
+                auto next_rank = index.rank(next);
+
+                if (!is_visited(next_rank))
+                {
+                    set(next_rank, distance);
+                    next_level.push_back(static_cast<std::uint32_t>(next_rank));
+                }
+            }
+        }
+
+        current_level.swap(next_level);
+        next_level.clear();
+
+        if (!current_level.empty())
+        {
+            ++depth;
+        }
+    }
+
+    oracle.max_distance_ = depth;
+    oracle.entries_ = oracle.storage_.data();
+
+    return oracle;
+}
+
+/**
+* \brief Loads table from file
+*
+* \details File is mapped to memory and entries are read directly from the mapping
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the file written by save()
+*
+* @return Loaded table, uninitialized table if the file is missing or malformed
+*/
+template <std::size_t Rows, std::size_t Cols>
+MoveOracle<Rows, Cols> MoveOracle<Rows, Cols>::load(const std::string &path)
+{
+    auto oracle = MoveOracle{};
+    auto file = MappedFile(path);
+
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    const auto *data = file.data();
+    std::size_t offset = 0;
+
+    // Reads value from the file, returns false if the file is too short
+    auto read = [&](void *value, std::size_t size)
+    {
+        if (offset + size > file.size())
+        {
+            return false;
+        }
+
+        std::memcpy(value, data + offset, size);
+        offset += size;
+
+        return true;
+    };
+
+    char magic[4]{};
+    std::uint32_t file_version{}, rows{}, cols{};
+    std::uint64_t entries{};
+
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, magic_, sizeof(magic)) != 0
+        || !read(&file_version, sizeof(file_version)) || file_version != version
+        || !read(&rows, sizeof(rows)) || rows != Rows
+        || !read(&cols, sizeof(cols)) || cols != Cols
+        || !read(oracle.target_.data.data(), sizeof(oracle.target_.data))
+        || !read(&entries, sizeof(entries)) || entries != boards_
+        || !read(&oracle.max_distance_, sizeof(oracle.max_distance_)) || oracle.max_distance_ >= boards_)
+    {
+        return {};
+    }
+
+    const auto target = GameBoard<Rows, Cols>(oracle.target_);
+    offset = (offset + 63) / 64 * 64;
+
+    if (!target.is_init() || offset + bytes_ > file.size())
+    {
+        return {};
+    }
+
+    oracle.index_ = PermutationIndex<Rows, Cols>(target);
+    oracle.entries_ = data + offset;
+    oracle.file_ = std::move(file);
+
+    return oracle;
+}
+
+/**
+* \brief Writes table to file
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the file
+*
+* @return True if the file was written, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool MoveOracle<Rows, Cols>::save(const std::string &path) const
+{
+    auto stream = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    if (!stream || !is_init())
+    {
+        return false;
+    }
+
+    auto write = [&stream](const void *value, std::size_t size)
+    {
+        stream.write(static_cast<const char*>(value), static_cast<std::streamsize>(size));
+    };
+
+    const std::uint32_t rows = Rows;
+    const std::uint32_t cols = Cols;
+    const std::uint64_t entries = boards_;
+
+    write(magic_, sizeof(magic_));
+    write(&version, sizeof(version));
+    write(&rows, sizeof(rows));
+    write(&cols, sizeof(cols));
+    write(target_.data.data(), sizeof(target_.data));
+    write(&entries, sizeof(entries));
+    write(&max_distance_, sizeof(max_distance_));
+
+    const std::size_t offset = sizeof(magic_) + 4 * sizeof(std::uint32_t) + sizeof(target_.data) + sizeof(entries);
+
+    // Align entries, so that the mapping starts them at cache line boundary
+    const char padding[64]{};
+    write(padding, (64 - offset % 64) % 64);
+    write(entries_, bytes_);
+
+    return static_cast<bool>(stream);
+}
+
+/**
+* \brief Restores optimal path from the board to the target
+*
+* \details Neighbours of a board are exactly one move closer or farther,
+* so the neighbour whose entry is one less modulo 15 lies on an optimal path.
+* Entries of a damaged file may break the chain, path is then given up
+* once no neighbour is closer or the largest distance of the table is walked.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+*
+* @return Optimal solution, not found solution if the target can't be reached or the table is inconsistent
+*/
+template <std::size_t Rows, std::size_t Cols>
+Solution<Rows, Cols> MoveOracle<Rows, Cols>::solve(const GameBoard<Rows, Cols> &initial) const
+{
+    if (!is_init() || !is_solvable(initial, GameBoard<Rows, Cols>(target_)))
+    {
+        return {};
+    }
+
+    auto board = initial;
+    auto distance = this->distance(board);
+    auto moves = std::vector<Direction>{};
+    std::size_t lookups = 1;
+
+    if (distance == unreachable)
+    {
+        return {};
+    }
+
+    while (board.key() != target_)
+    {
+        if (moves.size() >= max_distance_)
+        {
+            return {};
+        }
+
+        const auto closer = static_cast<std::uint8_t>((distance + unreachable - 1) % unreachable);
+        const auto length = moves.size();
+
+        for (Direction direction : { Direction::DOWN, Direction::LEFT, Direction::UP, Direction::RIGHT })
+        {
+            if (!board.apply(direction))
+            {
+                continue;
+            }
+
+            ++lookups;
+
+            if (this->distance(board) == closer)
+            {
+                moves.push_back(direction);
+                break;
+            }
+
+            board.apply(opposite(direction));
+        }
+
+        if (moves.size() == length)
+        {
+            return {};
+        }
+
+        distance = closer;
+    }
+
+    return { initial, std::move(moves), lookups };
+}
+
+#endif // MOVE_ORACLE_H_
@@ -0,0 +1,109 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+/**
+* \brief Lock-free queue with many producers and a single consumer
+*
+* \details Intrusive linked list by Dmitry Vyukov. Producers publish a node with one atomic exchange
+* and never wait for each other, consumer walks the list without atomic read-modify-write operations.
+* Node pushed by a producer may stay invisible to the consumer until the producer links it,
+* so pop() can miss the most recent values for a short time.
+*
+* @tparam T stored value, has to be default constructible and movable
+*/
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue() = default;
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue()
+    {
+        auto value = T{};
+
+        while (pop(value))
+        {
+        }
+
+        if (tail_ != &stub_)
+        {
+            delete tail_;
+        }
+    }
+
+    /**
+    * \brief Appends the value, may be called from any thread
+    */
+    void push(T value)
+    {
+        auto *node = new Node{};
+        node->value = std::move(value);
+
+        auto *previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+    * \brief Removes the oldest value, may be called only from the consumer thread
+    *
+    * @return True if the value was removed, false if the queue looks empty
+    */
+    bool pop(T &value)
+    {
+        auto *tail = tail_;
+        auto *next = tail->next.load(std::memory_order_acquire);
+
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        // Node of the removed value becomes the new stub
+        value = std::move(next->value);
+        tail_ = next;
+
+        if (tail != &stub_)
+        {
+            delete tail;
+        }
+
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        T value{};
+    };
+
+    Node stub_{}; ///< first node of the empty queue
+    std::atomic<Node*> head_{ &stub_ }; ///< last pushed node
+    Node *tail_{ &stub_ }; ///< node before the oldest value
+};
+
+#endif // MPSC_QUEUE_H_
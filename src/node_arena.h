@@ -0,0 +1,157 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef NODE_ARENA_H_
+#define NODE_ARENA_H_
+
+#include "game_board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+constexpr std::uint32_t no_parent = UINT32_MAX; ///< parent index of the root node
+
+/**
+* \brief Node of the search tree
+*
+* \details Board itself is kept in the packed form,
+* path is restored by walking parent indices
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+struct SearchNode
+{
+    typename GameBoard<Rows, Cols>::Key key{}; ///< packed board
+    std::uint32_t parent{ no_parent }; ///< index of the parent node in the arena
+    Direction move{}; ///< move which produced the board from its parent
+};
+
+/**
+* \brief Node of the search tree with path cost
+*
+* \details Used by informed searches, which need to know
+* the number of moves from the initial board and the distance to the target
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+struct CostNode
+{
+    typename GameBoard<Rows, Cols>::Key key{}; ///< packed board
+    std::uint32_t parent{ no_parent }; ///< index of the parent node in the arena
+    Direction move{}; ///< move which produced the board from its parent
+    std::uint16_t cost{ 0 }; ///< number of moves from the initial board
+    float distance{ 0.0f }; ///< heuristic distance to the target board
+};
+
+/**
+* \brief Storage of search nodes
+*
+* \details Nodes are allocated in contiguous chunks and addressed with 32-bit indices,
+* which are never invalidated by further pushes.
+* Everything is freed at once when the arena is destroyed or cleared.
+*
+* @tparam Node type of the stored node, has to provide parent and move members
+*/
+template <typename Node>
+class NodeArena
+{
+public:
+    NodeArena() = default;
+
+    std::uint32_t push(const Node &node)
+    {
+        if (size_ == chunks_.size() * chunk_size_)
+        {
+            chunks_.push_back(std::make_unique<Node[]>(chunk_size_));
+        }
+
+        chunks_[size_ / chunk_size_][size_ % chunk_size_] = node;
+
+        return static_cast<std::uint32_t>(size_++);
+    }
+
+    Node& operator[](std::uint32_t index) noexcept
+    {
+        return chunks_[index / chunk_size_][index % chunk_size_];
+    }
+
+    const Node& operator[](std::uint32_t index) const noexcept
+    {
+        return chunks_[index / chunk_size_][index % chunk_size_];
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+    * \brief Returns number of bytes taken by allocated chunks
+    */
+    std::size_t memory() const noexcept
+    {
+        return chunks_.size() * chunk_size_ * sizeof(Node) + chunks_.capacity() * sizeof(chunks_[0]);
+    }
+
+    void clear() noexcept
+    {
+        chunks_.clear();
+        size_ = 0;
+    }
+
+private:
+    static constexpr std::size_t chunk_size_ = 4096; ///< number of nodes in one chunk
+
+    std::vector< std::unique_ptr<Node[]> > chunks_{}; ///< allocated chunks
+    std::size_t size_{ 0 }; ///< number of stored nodes
+};
+
+/**
+* \brief Restores moves which lead to the given node
+*
+* @tparam Node type of the stored node
+*
+* @param arena storage of the search tree
+* @param index index of the last node of the path
+*
+* @return Moves from the root of the search tree to the given node
+*/
+template <typename Node>
+std::vector<Direction> trace_moves(const NodeArena<Node> &arena, std::uint32_t index)
+{
+    auto moves = std::vector<Direction>{};
+
+    while (arena[index].parent != no_parent)
+    {
+        moves.push_back(arena[index].move);
+        index = arena[index].parent;
+    }
+
+    std::reverse(moves.begin(), moves.end());
+
+    return moves;
+}
+
+#endif // NODE_ARENA_H_
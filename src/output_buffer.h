@@ -0,0 +1,165 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef OUTPUT_BUFFER_H_
+#define OUTPUT_BUFFER_H_
+
+#include <cstddef>
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+* \brief Buffered sink for formatted output
+*
+* \details Text is appended to a plain string and handed to the stream in large blocks,
+* so writing many short pieces costs neither virtual calls nor locale lookups of std::ostream.
+* Numbers are formatted with std::to_chars. Without a stream the buffer only collects the text,
+* which lets workers format their results before they are written in order.
+*/
+class OutputBuffer
+{
+public:
+    /**
+    * \brief Creates buffer which only collects text
+    */
+    OutputBuffer() = default;
+
+    /**
+    * \brief Creates buffer which writes to the stream
+    *
+    * @param stream destination of the text
+    * @param capacity number of bytes collected before they are written
+    */
+    explicit OutputBuffer(std::ostream &stream, std::size_t capacity = std::size_t{ 1 } << 16)
+        : stream_{ &stream }, capacity_{ capacity }
+    {
+        text_.reserve(capacity);
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    OutputBuffer& operator<<(char value)
+    {
+        text_.push_back(value);
+        return spill();
+    }
+
+    OutputBuffer& operator<<(std::string_view value)
+    {
+        text_.append(value);
+        return spill();
+    }
+
+    OutputBuffer& operator<<(const char *value)
+    {
+        return *this << std::string_view(value);
+    }
+
+    OutputBuffer& operator<<(const std::string &value)
+    {
+        return *this << std::string_view(value);
+    }
+
+    /**
+    * \brief Appends integer in decimal
+    */
+    template <typename Integer, typename = std::enable_if_t< std::is_integral<Integer>::value && !std::is_same<Integer, char>::value && !std::is_same<Integer, bool>::value >>
+    OutputBuffer& operator<<(Integer value)
+    {
+        char digits[24];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+
+        return *this << std::string_view(digits, static_cast<std::size_t>(result.ptr - digits));
+    }
+
+    /**
+    * \brief Appends number with six significant digits, as std::ostream does by default
+    */
+    OutputBuffer& operator<<(double value)
+    {
+        char digits[32];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+
+        return *this << std::string_view(digits, static_cast<std::size_t>(result.ptr - digits));
+    }
+
+    /**
+    * \brief Returns collected text which wasn't written yet
+    */
+    const std::string& text() const noexcept
+    {
+        return text_;
+    }
+
+    /**
+    * \brief Takes collected text away from the buffer
+    */
+    std::string release()
+    {
+        auto text = std::move(text_);
+        text_.clear();
+
+        return text;
+    }
+
+    /**
+    * \brief Writes collected text to the stream
+    *
+    * @return False if there is a stream and it failed, true otherwise
+    */
+    bool flush()
+    {
+        if (stream_ == nullptr)
+        {
+            return true;
+        }
+
+        stream_->write(text_.data(), static_cast<std::streamsize>(text_.size()));
+        stream_->flush();
+        text_.clear();
+
+        return static_cast<bool>(*stream_);
+    }
+
+private:
+    std::ostream *stream_{ nullptr }; ///< destination of the text, nullptr if the text is only collected
+    std::size_t capacity_{ 0 }; ///< number of bytes collected before they are written
+    std::string text_{}; ///< text which wasn't written yet
+
+    OutputBuffer& spill()
+    {
+        if (stream_ != nullptr && text_.size() >= capacity_)
+        {
+            stream_->write(text_.data(), static_cast<std::streamsize>(text_.size()));
+            text_.clear();
+        }
+
+        return *this;
+    }
+};
+
+#endif // OUTPUT_BUFFER_H_
@@ -0,0 +1,714 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef PATTERN_DATABASE_H_
+#define PATTERN_DATABASE_H_
+
+#include "game_board.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <utility>
+
+/**
+* \brief Additive disjoint pattern databases
+*
+* \details Tiles are split into disjoint patterns, for every pattern the database stores
+* the least number of moves of pattern tiles needed to bring them to their target cells
+* from any placement. Moves of other tiles are free, so values of different patterns
+* can be summed and the sum never exceeds the real number of moves.
+*
+* Tables are built by retrograde breadth-first search from the target over placements
+* of pattern tiles and the blank. They can be saved to a versioned binary file
+* and loaded back with mmap, so every process shares one copy from the page cache.
+*
+* The search keeps a byte for every placement and cell of the blank, patterns for which it would take
+* more than max_build_bytes are rejected: 7 tiles of the 15-puzzle take 922 MB, 8 tiles would take 8.3 GB,
+* so the 7-8 partition can't be built and 6-6-3 is the practical one.
+*
+* File layout (native byte order):
+* "NPDB", version, number of rows, number of columns, number of patterns, packed target board,
+* then for every pattern: number of tiles, tile ids, number of entries,
+* then entries of all patterns one by one starting at 64-byte aligned offset.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class PatternDatabase
+{
+public:
+    using Pattern = std::vector<std::uint8_t>; ///< ids of tiles in the pattern
+
+    static constexpr std::uint32_t version = 2; ///< version of the file format
+    static constexpr std::uint64_t max_build_bytes = std::uint64_t{ 1 } << 30; ///< largest search of a single pattern
+
+    PatternDatabase() = default;
+
+    PatternDatabase(const PatternDatabase&) = delete;
+    PatternDatabase& operator=(const PatternDatabase&) = delete;
+
+    PatternDatabase(PatternDatabase&&) = default;
+    PatternDatabase& operator=(PatternDatabase&&) = default;
+
+    static std::vector<Pattern> partition(const GameBoard<Rows, Cols> &target, const std::vector<std::size_t> &sizes);
+
+    /**
+    * \brief Returns the largest number of tiles of a pattern which can be built within max_build_bytes
+    */
+    static std::size_t largest_pattern() noexcept
+    {
+        std::size_t tiles = 1;
+
+        while (tiles + 1 < cells_ && placements(tiles + 1) * cells_ <= max_build_bytes)
+        {
+            ++tiles;
+        }
+
+        return tiles;
+    }
+
+    static PatternDatabase build(const GameBoard<Rows, Cols> &target, const std::vector<Pattern> &patterns);
+    static PatternDatabase load(const std::string &path);
+
+    bool save(const std::string &path) const;
+
+    /**
+    * \brief Checks whether the database is built or loaded
+    */
+    bool is_init() const noexcept
+    {
+        return !patterns_.empty();
+    }
+
+    /**
+    * \brief Checks whether the database was built for the given target
+    */
+    bool matches(const GameBoard<Rows, Cols> &target) const noexcept
+    {
+        return is_init() && target.key() == target_;
+    }
+
+    float distance(const GameBoard<Rows, Cols> &board) const noexcept;
+    float update(float distance, const GameBoard<Rows, Cols> &board, std::size_t previous_blank) const noexcept;
+
+private:
+    static constexpr std::size_t cells_ = Rows * Cols; ///< number of cells on the board
+    static constexpr std::size_t tiles_ = std::size_t{ 1 } << GameBoard<Rows, Cols>::Key::bits; ///< number of possible tile ids
+    static constexpr std::uint8_t no_pattern_ = 0xFF; ///< pattern index of tiles which aren't in any pattern
+    static constexpr std::uint8_t unvisited_ = 0xFF; ///< distance of placements not reached yet
+    static constexpr char magic_[4] = { 'N', 'P', 'D', 'B' }; ///< first bytes of the file
+
+    using Cells = std::array<std::uint8_t, cells_>; ///< cells of pattern tiles
+
+    struct PatternTable
+    {
+        Pattern tiles; ///< ids of tiles in the pattern
+        const std::uint8_t *entries; ///< distance of every placement of tiles
+        std::uint64_t size; ///< number of placements
+    };
+
+    typename GameBoard<Rows, Cols>::Key target_{}; ///< target board
+    std::vector<PatternTable> patterns_{}; ///< tables of all patterns
+    std::array<std::uint8_t, tiles_> pattern_of_{}; ///< index of the pattern of every tile
+    std::array<std::uint8_t, tiles_> slot_of_{}; ///< index of every tile within its pattern
+
+    std::vector<std::uint8_t> storage_{}; ///< entries if the database was built in memory
+    MappedFile file_{}; ///< entries if the database was loaded from file
+
+    static std::uint64_t placements(std::size_t tiles) noexcept;
+    static std::uint64_t rank(const Cells &cells, std::size_t tiles) noexcept;
+    static void unrank(std::uint64_t index, std::size_t tiles, Cells &cells) noexcept;
+
+    static bool is_partition(const std::vector<Pattern> &patterns);
+    static void build_table(const GameBoard<Rows, Cols> &target, const Pattern &pattern, std::uint8_t *entries);
+
+    void index_patterns();
+};
+
+/**
+* \brief Splits tiles into patterns
+*
+* \details Tiles are taken in the order of their target cells,
+* e.g. sizes {6, 6, 3} give the 6-6-3 partition of the 15-puzzle
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param target target board
+* @param sizes number of tiles in every pattern
+*
+* @return Tile ids of every pattern
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::vector<typename PatternDatabase<Rows, Cols>::Pattern> PatternDatabase<Rows, Cols>::partition(const GameBoard<Rows, Cols> &target,
+    const std::vector<std::size_t> &sizes)
+{
+    auto patterns = std::vector<Pattern>{};
+    std::size_t cell = 0;
+
+    for (std::size_t size : sizes)
+    {
+        auto pattern = Pattern{};
+
+        while (pattern.size() < size && cell < cells_)
+        {
+            if (target.tile(cell) != 0)
+            {
+                pattern.push_back(target.tile(cell));
+            }
+            ++cell;
+        }
+
+        if (!pattern.empty())
+        {
+            patterns.push_back(pattern);
+        }
+    }
+
+    return patterns;
+}
+
+/**
+* \brief Builds database for the given target
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param target target board
+* @param patterns disjoint sets of tile ids, each small enough to be searched within max_build_bytes
+*
+* @return Database held in memory, uninitialized database if patterns overlap or are too large
+*/
+template <std::size_t Rows, std::size_t Cols>
+PatternDatabase<Rows, Cols> PatternDatabase<Rows, Cols>::build(const GameBoard<Rows, Cols> &target, const std::vector<Pattern> &patterns)
+{
+    if (!is_partition(patterns))
+    {
+        return {};
+    }
+
+    auto database = PatternDatabase{};
+    std::uint64_t total = 0;
+
+    for (const Pattern &pattern : patterns)
+    {
+        total += placements(pattern.size());
+    }
+
+    database.target_ = target.key();
+    database.storage_.resize(static_cast<std::size_t>(total));
+
+    auto entries = database.storage_.data();
+
+    for (const Pattern &pattern : patterns)
+    {
+        build_table(target, pattern, entries);
+        database.patterns_.push_back({ pattern, entries, placements(pattern.size()) });
+
+        entries += placements(pattern.size());
+    }
+
+    database.index_patterns();
+
+    return database;
+}
+
+/**
+* \brief Loads database from file
+*
+* \details File is mapped to memory and entries are read directly from the mapping
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the file written by save()
+*
+* @return Loaded database, uninitialized database if the file is missing or malformed or its patterns overlap
+*/
+template <std::size_t Rows, std::size_t Cols>
+PatternDatabase<Rows, Cols> PatternDatabase<Rows, Cols>::load(const std::string &path)
+{
+    auto database = PatternDatabase{};
+    auto file = MappedFile(path);
+
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    const auto *data = file.data();
+    std::size_t offset = 0;
+
+    // Reads value from the file, returns false if the file is too short
+    auto read = [&](void *value, std::size_t size)
+    {
+        if (offset + size > file.size())
+        {
+            return false;
+        }
+
+        std::memcpy(value, data + offset, size);
+        offset += size;
+
+        return true;
+    };
+
+    char magic[4]{};
+    std::uint32_t file_version{}, rows{}, cols{}, count{};
+
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, magic_, sizeof(magic)) != 0
+        || !read(&file_version, sizeof(file_version)) || file_version != version
+        || !read(&rows, sizeof(rows)) || rows != Rows
+        || !read(&cols, sizeof(cols)) || cols != Cols
+        || !read(&count, sizeof(count))
+        || !read(database.target_.data.data(), sizeof(database.target_.data)))
+    {
+        return {};
+    }
+
+    auto tables = std::vector<PatternTable>{};
+
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        std::uint32_t tiles{};
+        std::uint64_t entries{};
+        auto pattern = Pattern{};
+
+        if (!read(&tiles, sizeof(tiles)) || tiles == 0 || tiles >= cells_)
+        {
+            return {};
+        }
+
+        pattern.resize(tiles);
+
+        if (!read(pattern.data(), tiles) || !read(&entries, sizeof(entries)) || entries != placements(tiles))
+        {
+            return {};
+        }
+
+        tables.push_back({ pattern, nullptr, entries });
+    }
+
+    // Overlapping patterns would count moves of shared tiles twice
+    auto patterns = std::vector<Pattern>{};
+
+    for (const PatternTable &table : tables)
+    {
+        patterns.push_back(table.tiles);
+    }
+
+    if (!is_partition(patterns))
+    {
+        return {};
+    }
+
+    offset = (offset + 63) / 64 * 64;
+
+    for (PatternTable &table : tables)
+    {
+        if (offset + table.size > file.size())
+        {
+            return {};
+        }
+
+        table.entries = data + offset;
+        offset += static_cast<std::size_t>(table.size);
+    }
+
+    database.patterns_ = std::move(tables);
+    database.file_ = std::move(file);
+    database.index_patterns();
+
+    return database;
+}
+
+/**
+* \brief Writes database to file
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the file
+*
+* @return True if the file was written, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool PatternDatabase<Rows, Cols>::save(const std::string &path) const
+{
+    auto stream = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    if (!stream || !is_init())
+    {
+        return false;
+    }
+
+    auto write = [&stream](const void *value, std::size_t size)
+    {
+        stream.write(static_cast<const char*>(value), static_cast<std::streamsize>(size));
+    };
+
+    const std::uint32_t rows = Rows;
+    const std::uint32_t cols = Cols;
+    const auto count = static_cast<std::uint32_t>(patterns_.size());
+
+    write(magic_, sizeof(magic_));
+    write(&version, sizeof(version));
+    write(&rows, sizeof(rows));
+    write(&cols, sizeof(cols));
+    write(&count, sizeof(count));
+    write(target_.data.data(), sizeof(target_.data));
+
+    std::size_t offset = sizeof(magic_) + 4 * sizeof(std::uint32_t) + sizeof(target_.data);
+
+    for (const PatternTable &table : patterns_)
+    {
+        const auto tiles = static_cast<std::uint32_t>(table.tiles.size());
+
+        write(&tiles, sizeof(tiles));
+        write(table.tiles.data(), table.tiles.size());
+        write(&table.size, sizeof(table.size));
+
+        offset += sizeof(tiles) + table.tiles.size() + sizeof(table.size);
+    }
+
+    // Align entries, so that the mapping starts them at cache line boundary
+    const char padding[64]{};
+    write(padding, (64 - offset % 64) % 64);
+
+    for (const PatternTable &table : patterns_)
+    {
+        write(table.entries, static_cast<std::size_t>(table.size));
+    }
+
+    return static_cast<bool>(stream);
+}
+
+/**
+* \brief Computes distance of the board to the target
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param board board from which distance is computed
+*
+* @return Sum of distances of all patterns
+*/
+template <std::size_t Rows, std::size_t Cols>
+float PatternDatabase<Rows, Cols>::distance(const GameBoard<Rows, Cols> &board) const noexcept
+{
+    auto positions = std::array<std::uint8_t, tiles_>{};
+
+    for (std::size_t cell = 0; cell < cells_; cell++)
+    {
+        positions[board.tile(cell)] = static_cast<std::uint8_t>(cell);
+    }
+
+    std::uint32_t distance = 0;
+    Cells cells{};
+
+    for (const PatternTable &table : patterns_)
+    {
+        for (std::size_t i = 0; i < table.tiles.size(); i++)
+        {
+            cells[i] = positions[table.tiles[i]];
+        }
+
+        distance += table.entries[rank(cells, table.tiles.size())];
+    }
+
+    return static_cast<float>(distance);
+}
+
+/**
+* \brief Computes distance of the board after a single move
+*
+* \details Only the pattern of the moved tile is looked up, its cells are collected in one pass over the board
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param distance distance of the board before the move
+* @param board board after the move
+* @param previous_blank cell of the blank tile before the move
+*
+* @return Distance of the board after the move
+*/
+template <std::size_t Rows, std::size_t Cols>
+float PatternDatabase<Rows, Cols>::update(float distance, const GameBoard<Rows, Cols> &board, std::size_t previous_blank) const noexcept
+{
+    auto tile = board.tile(previous_blank);
+    auto pattern = pattern_of_[tile];
+
+    // Moves of tiles outside of patterns are free
+    if (pattern == no_pattern_)
+    {
+        return distance;
+    }
+
+    const auto &table = patterns_[pattern];
+    Cells cells{};
+
+    for (std::size_t cell = 0; cell < cells_; cell++)
+    {
+        auto other = board.tile(cell);
+
+        if (pattern_of_[other] == pattern)
+        {
+            cells[slot_of_[other]] = static_cast<std::uint8_t>(cell);
+        }
+    }
+
+    auto after = table.entries[rank(cells, table.tiles.size())];
+    cells[slot_of_[tile]] = static_cast<std::uint8_t>(board.blank_cell());
+    auto before = table.entries[rank(cells, table.tiles.size())];
+
+    return distance - before + after;
+}
+
+/**
+* \brief Returns number of placements of the given number of tiles
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::uint64_t PatternDatabase<Rows, Cols>::placements(std::size_t tiles) noexcept
+{
+    std::uint64_t result = 1;
+
+    for (std::size_t i = 0; i < tiles; i++)
+    {
+        result *= cells_ - i;
+    }
+
+    return result;
+}
+
+/**
+* \brief Computes index of the placement of pattern tiles
+*
+* \details Placement is ranked as partial permutation of cells,
+* digit i is the number of free cells before the cell of tile i
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::uint64_t PatternDatabase<Rows, Cols>::rank(const Cells &cells, std::size_t tiles) noexcept
+{
+    std::uint64_t index = 0;
+
+    for (std::size_t i = 0; i < tiles; i++)
+    {
+        std::uint64_t digit = cells[i];
+
+        for (std::size_t j = 0; j < i; j++)
+        {
+            digit -= (cells[j] < cells[i]) ? 1 : 0;
+        }
+
+        index = index * (cells_ - i) + digit;
+    }
+
+    return index;
+}
+
+/**
+* \brief Restores placement of pattern tiles from its index
+*/
+template <std::size_t Rows, std::size_t Cols>
+void PatternDatabase<Rows, Cols>::unrank(std::uint64_t index, std::size_t tiles, Cells &cells) noexcept
+{
+    std::array<std::uint8_t, cells_> digits{};
+
+    for (std::size_t i = tiles; i-- > 0; )
+    {
+        digits[i] = static_cast<std::uint8_t>(index % (cells_ - i));
+        index /= cells_ - i;
+    }
+
+    std::array<bool, cells_> used{};
+
+    for (std::size_t i = 0; i < tiles; i++)
+    {
+        std::size_t cell = 0;
+
+        // Find free cell with the given number of free cells before it
+        for (std::size_t free = 0; ; cell++)
+        {
+            if (!used[cell] && free++ == digits[i])
+            {
+                break;
+            }
+        }
+
+        used[cell] = true;
+        cells[i] = static_cast<std::uint8_t>(cell);
+    }
+}
+
+/**
+* \brief Checks that patterns are non-empty, small enough to build and share no tiles
+*
+* \details Tiles have to be ids of non-blank tiles of the board
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool PatternDatabase<Rows, Cols>::is_partition(const std::vector<Pattern> &patterns)
+{
+    std::array<bool, tiles_> used{};
+
+    for (const Pattern &pattern : patterns)
+    {
+        if (pattern.empty() || pattern.size() >= cells_ || placements(pattern.size()) * cells_ > max_build_bytes)
+        {
+            return false;
+        }
+
+        for (std::uint8_t tile : pattern)
+        {
+            if (tile == 0 || tile >= cells_ || used[tile])
+            {
+                return false;
+            }
+
+            used[tile] = true;
+        }
+    }
+
+    return !patterns.empty();
+}
+
+/**
+* \brief Fills table of a single pattern
+*
+* \details Breadth-first search over placements of pattern tiles together with the blank.
+* Moving a pattern tile costs one move, moving any other tile is free,
+* so free moves are expanded within the current level.
+* Entry of the placement is the least distance among all cells of the blank.
+*/
+template <std::size_t Rows, std::size_t Cols>
+void PatternDatabase<Rows, Cols>::build_table(const GameBoard<Rows, Cols> &target, const Pattern &pattern, std::uint8_t *entries)
+{
+    const auto tiles = pattern.size();
+    const auto size = placements(tiles);
+
+    auto distances = std::vector<std::uint8_t>(static_cast<std::size_t>(size * cells_), unvisited_);
+    Cells cells{};
+
+    for (std::size_t cell = 0; cell < cells_; cell++)
+    {
+        auto position = std::find(pattern.begin(), pattern.end(), target.tile(cell));
+
+        if (position != pattern.end())
+        {
+            cells[position - pattern.begin()] = static_cast<std::uint8_t>(cell);
+        }
+    }
+
+    auto current = std::vector<std::uint64_t>{ rank(cells, tiles) * cells_ + target.blank_cell() };
+    auto next = std::vector<std::uint64_t>{};
+    auto stack = std::vector<std::uint64_t>{};
+
+    for (std::uint8_t level = 0; !current.empty(); level++)
+    {
+        for (std::uint64_t state : current)
+        {
+            if (distances[static_cast<std::size_t>(state)] == unvisited_)
+            {
+                distances[static_cast<std::size_t>(state)] = level;
+                stack.push_back(state);
+            }
+        }
+
+        current.clear();
+
+        while (!stack.empty())
+        {
+            auto state = stack.back();
+            stack.pop_back();
+
+            auto blank = static_cast<std::size_t>(state % cells_);
+            unrank(state / cells_, tiles, cells);
+
+            for (std::size_t neighbour : BoardGeometry<Rows, Cols>::neighbours[blank])
+            {
+                if (neighbour == BoardGeometry<Rows, Cols>::no_cell)
+                {
+                    continue;
+                }
+
+                auto tile = std::find(cells.begin(), cells.begin() + tiles, static_cast<std::uint8_t>(neighbour));
+
+                if (tile == cells.begin() + tiles)
+                {
+                    // Free move, the board stays at the current level
+                    auto child = state - blank + neighbour;
+
+                    if (distances[static_cast<std::size_t>(child)] == unvisited_)
+                    {
+                        distances[static_cast<std::size_t>(child)] = level;
+                        stack.push_back(child);
+                    }
+                }
+                else
+                {
+                    *tile = static_cast<std::uint8_t>(blank);
+                    auto child = rank(cells, tiles) * cells_ + neighbour;
+                    *tile = static_cast<std::uint8_t>(neighbour);
+
+                    if (distances[static_cast<std::size_t>(child)] == unvisited_)
+                    {
+                        next.push_back(child);
+                    }
+                }
+            }
+        }
+
+        current.swap(next);
+    }
+
+    for (std::uint64_t index = 0; index < size; index++)
+    {
+        auto first = distances.begin() + static_cast<std::ptrdiff_t>(index * cells_);
+
+        entries[index] = *std::min_element(first, first + cells_);
+    }
+}
+
+/**
+* \brief Remembers pattern of every tile
+*/
+template <std::size_t Rows, std::size_t Cols>
+void PatternDatabase<Rows, Cols>::index_patterns()
+{
+    pattern_of_.fill(no_pattern_);
+    slot_of_.fill(0);
+
+    for (std::size_t i = 0; i < patterns_.size(); i++)
+    {
+        for (std::size_t slot = 0; slot < patterns_[i].tiles.size(); slot++)
+        {
+            pattern_of_[patterns_[i].tiles[slot]] = static_cast<std::uint8_t>(i);
+            slot_of_[patterns_[i].tiles[slot]] = static_cast<std::uint8_t>(slot);
+        }
+    }
+}
+
+#endif // PATTERN_DATABASE_H_
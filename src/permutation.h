@@ -0,0 +1,390 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef PERMUTATION_H_
+#define PERMUTATION_H_
+
+#include "game_board.h"
+#include "state_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+/**
+* \brief Dense numbering of boards
+*
+* \details Board is seen as a permutation of cells: element of the cell is
+* the target cell of the tile in it. Permutations are ranked in linear time
+* by the Myrvold-Ruskey algorithm, so every board gets a unique index below (Rows*Cols)!.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class PermutationIndex
+{
+public:
+    static constexpr std::size_t cells = Rows * Cols; ///< number of cells on the board
+
+    PermutationIndex() = delete;
+
+    explicit PermutationIndex(const GameBoard<Rows, Cols> &target);
+
+    /**
+    * \brief Returns number of indices
+    */
+    static constexpr std::uint64_t size() noexcept
+    {
+        std::uint64_t result = 1;
+
+        for (std::size_t i = 2; i <= cells; i++)
+        {
+            result *= i;
+        }
+
+        return result;
+    }
+
+    std::uint64_t rank(const GameBoard<Rows, Cols> &board) const noexcept;
+    GameBoard<Rows, Cols> unrank(std::uint64_t index) const;
+
+private:
+    using Permutation = std::array<std::uint8_t, cells>;
+
+    std::array<std::uint8_t, (std::size_t{ 1 } << GameBoard<Rows, Cols>::Key::bits)> goals_{}; ///< target cell of every tile
+    typename GameBoard<Rows, Cols>::Key target_{}; ///< target board
+};
+
+template <std::size_t Rows, std::size_t Cols>
+PermutationIndex<Rows, Cols>::PermutationIndex(const GameBoard<Rows, Cols> &target)
+    : target_{ target.key() }
+{
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        goals_[target.tile(cell)] = static_cast<std::uint8_t>(cell);
+    }
+}
+
+/**
+* \brief Computes index of the board
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param board board with the same tiles as the target
+*
+* @return Index of the board below size()
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::uint64_t PermutationIndex<Rows, Cols>::rank(const GameBoard<Rows, Cols> &board) const noexcept
+{
+    Permutation permutation{};
+    Permutation inverse{};
+    Permutation digits{};
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        permutation[cell] = goals_[board.tile(cell)];
+        inverse[permutation[cell]] = static_cast<std::uint8_t>(cell);
+    }
+
+    // Move the largest element to the end, the cell it came from is the digit
+    for (std::size_t n = cells; n > 1; n--)
+    {
+        auto digit = permutation[n - 1];
+
+        std::swap(permutation[n - 1], permutation[inverse[n - 1]]);
+        std::swap(inverse[digit], inverse[n - 1]);
+
+        digits[n - 1] = digit;
+    }
+
+    std::uint64_t index = 0;
+
+    for (std::size_t n = 2; n <= cells; n++)
+    {
+        index = digits[n - 1] + n * index;
+    }
+
+    return index;
+}
+
+/**
+* \brief Restores board from its index
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param index index of the board
+*
+* @return Board with the given index
+*/
+template <std::size_t Rows, std::size_t Cols>
+GameBoard<Rows, Cols> PermutationIndex<Rows, Cols>::unrank(std::uint64_t index) const
+{
+    Permutation permutation{};
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        permutation[cell] = static_cast<std::uint8_t>(cell);
+    }
+
+    // Undo the swaps of rank() in reverse order, the last one is the least significant digit
+    for (std::size_t n = cells; n > 1; n--)
+    {
+        std::swap(permutation[n - 1], permutation[static_cast<std::size_t>(index % n)]);
+        index /= n;
+    }
+
+    typename GameBoard<Rows, Cols>::Key key{};
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        key.set(cell, target_.get(permutation[cell]));
+    }
+
+    return GameBoard<Rows, Cols>(key);
+}
+
+/**
+* \brief Checks whether the target can be reached from the board
+*
+* \details Every move swaps the blank with a neighbour, so it changes parity of the permutation
+* and parity of the distance between the blank and its target cell together.
+* The target is reachable if and only if both parities are equal and both boards have the same tiles.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial initial board
+* @param target target board
+*
+* @return True if the puzzle is solvable, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool is_solvable(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target) noexcept
+{
+    constexpr std::size_t cells = Rows * Cols;
+    constexpr std::uint8_t missing = 0xFF;
+
+    if (!initial.is_init() || !target.is_init())
+    {
+        return false;
+    }
+
+    std::array<std::uint8_t, (std::size_t{ 1 } << GameBoard<Rows, Cols>::Key::bits)> goals{};
+    std::array<std::uint8_t, cells> permutation{};
+    std::array<bool, cells> seen{};
+
+    goals.fill(missing);
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        goals[target.tile(cell)] = static_cast<std::uint8_t>(cell);
+    }
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        permutation[cell] = goals[initial.tile(cell)];
+
+        // Tile of the initial board isn't on the target board or repeats
+        if (permutation[cell] == missing || seen[permutation[cell]])
+        {
+            return false;
+        }
+
+        seen[permutation[cell]] = true;
+    }
+
+    // Permutation is odd if it has odd number of cycles of even length
+    std::size_t parity = 0;
+    seen.fill(false);
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        std::size_t length = 0;
+
+        for (auto next = cell; !seen[next]; next = permutation[next])
+        {
+            seen[next] = true;
+            ++length;
+        }
+
+        if (length > 0)
+        {
+            parity += length - 1;
+        }
+    }
+
+    auto rows = static_cast<std::size_t>(initial.blank_cell() / Cols) + target.blank_cell() / Cols;
+    auto cols = static_cast<std::size_t>(initial.blank_cell() % Cols) + target.blank_cell() % Cols;
+
+    return parity % 2 == (rows + cols) % 2;
+}
+
+/**
+* \brief Set of visited boards
+*
+* \details Boards of small puzzles are ranked into a bitset with one bit for every permutation,
+* e.g. 45 KB for the 8-puzzle. Larger puzzles fall back to the hash set of packed boards.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class VisitedBoards
+{
+public:
+    static constexpr bool is_ranked = Rows * Cols <= 9; ///< true if boards are stored in the bitset
+
+    VisitedBoards() = delete;
+
+    explicit VisitedBoards(const GameBoard<Rows, Cols> &target)
+        : index_{ target }
+    {
+        if constexpr (is_ranked)
+        {
+            bits_.resize(static_cast<std::size_t>((PermutationIndex<Rows, Cols>::size() + 63) / 64));
+        }
+    }
+
+    /**
+    * \brief Marks the board as visited
+    *
+    * @return True if the board wasn't visited before, false otherwise
+    */
+    bool insert(const GameBoard<Rows, Cols> &board)
+    {
+        if constexpr (is_ranked)
+        {
+            auto rank = index_.rank(board);
+            auto &word = bits_[static_cast<std::size_t>(rank / 64)];
+            auto bit = std::uint64_t{ 1 } << (rank % 64);
+
+            if (word & bit)
+            {
+                return false;
+            }
+
+            word |= bit;
+
+            return true;
+        }
+        else
+        {
+            return set_.insert(board.key());
+        }
+    }
+
+    /**
+    * \brief Returns number of bytes taken by the set
+    */
+    std::size_t memory() const noexcept
+    {
+        return bits_.capacity() * sizeof(std::uint64_t) + set_.memory();
+    }
+
+private:
+    PermutationIndex<Rows, Cols> index_; ///< ranking of boards
+    std::vector<std::uint64_t> bits_{}; ///< bit of every permutation if boards are ranked
+    StateSet<typename GameBoard<Rows, Cols>::Key> set_{ is_ranked ? 0 : 1024 }; ///< packed boards otherwise
+};
+
+/**
+* \brief Set of visited boards shared by several threads
+*
+* \details Ranked boards set their bit with a single atomic or, so threads never wait for each other.
+* Larger puzzles use hash sets split into shards by the upper bits of the hash, each behind its own mutex.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class ConcurrentVisitedBoards
+{
+public:
+    static constexpr bool is_ranked = VisitedBoards<Rows, Cols>::is_ranked; ///< true if boards are stored in the bitset
+
+    ConcurrentVisitedBoards() = delete;
+
+    ConcurrentVisitedBoards(const ConcurrentVisitedBoards&) = delete;
+    ConcurrentVisitedBoards& operator=(const ConcurrentVisitedBoards&) = delete;
+
+    explicit ConcurrentVisitedBoards(const GameBoard<Rows, Cols> &target)
+        : index_{ target },
+          bits_(is_ranked ? static_cast<std::size_t>((PermutationIndex<Rows, Cols>::size() + 63) / 64) : 0)
+    {}
+
+    /**
+    * \brief Marks the board as visited, may be called from any thread
+    *
+    * @return True if the board wasn't visited before, false otherwise
+    */
+    bool insert(const GameBoard<Rows, Cols> &board)
+    {
+        if constexpr (is_ranked)
+        {
+            auto rank = index_.rank(board);
+            auto bit = std::uint64_t{ 1 } << (rank % 64);
+
+            return (bits_[static_cast<std::size_t>(rank / 64)].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+        }
+        else
+        {
+            auto &shard = shards_[static_cast<std::size_t>(static_cast<std::uint64_t>(board.key().hash()) >> (64 - shard_bits_))];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            return shard.set.insert(board.key());
+        }
+    }
+
+    /**
+    * \brief Returns number of bytes taken by the set, must not be called while other threads insert
+    */
+    std::size_t memory() const noexcept
+    {
+        auto result = bits_.capacity() * sizeof(bits_[0]);
+
+        for (const Shard &shard : shards_)
+        {
+            result += shard.set.memory();
+        }
+
+        return result;
+    }
+
+private:
+    static constexpr std::size_t shard_bits_ = 6; ///< log2 of the number of shards
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex{};
+        StateSet<typename GameBoard<Rows, Cols>::Key> set{ is_ranked ? 0 : 1024 };
+    };
+
+    PermutationIndex<Rows, Cols> index_; ///< ranking of boards
+    std::vector< std::atomic<std::uint64_t> > bits_; ///< bit of every permutation if boards are ranked
+    std::array<Shard, (std::size_t{ 1 } << shard_bits_)> shards_{}; ///< packed boards otherwise
+};
+
+#endif // PERMUTATION_H_
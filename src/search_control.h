@@ -0,0 +1,155 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SEARCH_CONTROL_H_
+#define SEARCH_CONTROL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <utility>
+
+/**
+* \brief Snapshot of a running search passed to the progress callback
+*/
+struct SearchProgress
+{
+    std::size_t expanded{ 0 }; ///< boards whose children were generated so far
+    std::size_t generated{ 0 }; ///< boards produced by moves so far
+    std::size_t bound{ 0 }; ///< current f-bound of informed searches, current depth of uninformed ones
+    std::size_t bytes{ 0 }; ///< bytes taken by the search structures
+};
+
+/**
+* \brief Reason why a search was stopped from outside
+*/
+enum class StopReason
+{
+    None, ///< search ran to its end
+    Cancelled, ///< cancel() was called
+    MemoryLimit ///< search structures grew beyond the memory limit
+};
+
+/**
+* \brief Cancellation token, progress callback and memory cap of one search
+*
+* \details Search looks at the token before every expansion and builds the progress
+* only once per period of expansions, so an idle control costs one relaxed load.
+* Searches which go level by level or in rounds of parallel expansions look at it once per level or round.
+* cancel() may be called from any thread, everything else belongs to the thread running the search.
+* Stopped search returns not found solution and leaves the reason in stop_reason().
+*/
+class SearchControl
+{
+public:
+    using Callback = std::function<void(const SearchProgress&)>;
+
+    SearchControl() = default;
+
+    explicit SearchControl(Callback callback, std::size_t period = 1 << 16, std::size_t memory_limit = SIZE_MAX)
+        : callback_{ std::move(callback) }, period_{ period == 0 ? 1 : period }, memory_limit_{ memory_limit }
+    {}
+
+    SearchControl(const SearchControl&) = delete;
+    SearchControl& operator=(const SearchControl&) = delete;
+
+    void cancel() noexcept
+    {
+        is_cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool is_cancelled() const noexcept
+    {
+        return is_cancelled_.load(std::memory_order_relaxed);
+    }
+
+    StopReason stop_reason() const noexcept
+    {
+        return reason_.load(std::memory_order_relaxed);
+    }
+
+    /**
+    * \brief Checks whether the search has to stop
+    *
+    * \details Progress is built, reported and compared with the memory limit once per period
+    *
+    * @tparam Progress function without arguments which returns SearchProgress
+    *
+    * @param expanded number of boards expanded by the search so far
+    * @param progress builder of the current progress
+    *
+    * @return True if the search was cancelled or went over the memory limit, false otherwise
+    */
+    template <typename Progress>
+    bool is_stopped(std::size_t expanded, Progress &&progress)
+    {
+        if (is_cancelled())
+        {
+            reason_.store(StopReason::Cancelled, std::memory_order_relaxed);
+            return true;
+        }
+        else if (expanded < next_report_)
+        {
+            return false;
+        }
+
+        next_report_ = expanded + period_;
+        const SearchProgress current = progress();
+
+        if (callback_)
+        {
+            callback_(current);
+        }
+
+        if (current.bytes > memory_limit_)
+        {
+            reason_.store(StopReason::MemoryLimit, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    Callback callback_{}; ///< receiver of the progress, may be empty
+    std::size_t period_{ 1 << 16 }; ///< number of expansions between reports
+    std::size_t memory_limit_{ SIZE_MAX }; ///< bytes after which the search stops
+    std::size_t next_report_{ period_ }; ///< number of expansions at which the next report is made
+    std::atomic<bool> is_cancelled_{ false }; ///< set by cancel()
+    std::atomic<StopReason> reason_{ StopReason::None }; ///< why the search stopped, read by other threads
+};
+
+/**
+* \brief Checks whether the search has to stop
+*
+* \details Search goes on unconditionally when no control is given
+*
+* @param control control of the search or nullptr
+* @param expanded number of boards expanded by the search so far
+* @param progress builder of the current progress
+*
+* @return True if the search has to stop, false otherwise
+*/
+template <typename Progress>
+bool is_stopped(SearchControl *control, std::size_t expanded, Progress &&progress)
+{
+    return control != nullptr && control->is_stopped(expanded, std::forward<Progress>(progress));
+}
+
+#endif // SEARCH_CONTROL_H_
@@ -0,0 +1,155 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SEARCH_STATS_H_
+#define SEARCH_STATS_H_
+
+#include <cstddef>
+#include <chrono>
+#include <ostream>
+
+/**
+* \brief Counters filled by a search
+*
+* \details Every search takes an optional pointer to the statistics and fills it when the pointer isn't null.
+* Phase times are measured only if measure_phases is set and only by single-threaded searches.
+* Clock reads around every move slow the search down, so they estimate the share of each phase rather than its exact cost.
+*/
+struct SearchStats
+{
+    std::size_t generated{ 0 }; ///< boards produced by moves
+    std::size_t expanded{ 0 }; ///< boards whose children were generated
+    std::size_t duplicates{ 0 }; ///< generated boards dropped because they were seen before with no shorter path
+    std::size_t peak_open{ 0 }; ///< largest number of boards waiting for expansion
+    std::size_t peak_closed{ 0 }; ///< largest number of boards remembered as seen
+    std::size_t bytes{ 0 }; ///< bytes taken by the search structures at the end of the search
+    std::size_t evaluations{ 0 }; ///< heuristic evaluations, both full and incremental
+    double move_seconds{ 0.0 }; ///< time spent generating moves
+    double heuristic_seconds{ 0.0 }; ///< time spent evaluating the heuristic
+    double dedup_seconds{ 0.0 }; ///< time spent looking up seen boards
+    double total_seconds{ 0.0 }; ///< wall time of the whole search
+    bool measure_phases{ false }; ///< set by the caller to fill times of the phases
+};
+
+/**
+* \brief Calls the function and adds its running time to the phase of the statistics
+*
+* \details Function is just called when statistics aren't collected
+*
+* @param stats statistics or nullptr
+* @param phase member of the statistics which accumulates the time
+* @param function measured function
+*
+* @return Result of the function
+*/
+template <typename Function>
+auto measure(SearchStats *stats, double SearchStats::*phase, Function &&function) -> decltype(function())
+{
+    if (stats == nullptr)
+    {
+        return function();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Result is kept in a variable, so it doesn't matter whether it is a reference or a value
+    decltype(auto) result = function();
+    stats->*phase += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+/**
+* \brief Measures wall time of the whole search
+*
+* \details Statistics except for the measure_phases flag are cleared when the timer is created,
+* the time is added when it is destroyed
+*/
+class SearchTimer
+{
+public:
+    explicit SearchTimer(SearchStats *stats)
+        : stats_{ stats }, measure_phases_{ stats != nullptr && stats->measure_phases }
+    {
+        if (stats_ != nullptr)
+        {
+            *stats_ = SearchStats{};
+            stats_->measure_phases = measure_phases_;
+        }
+    }
+
+    SearchTimer(const SearchTimer&) = delete;
+    SearchTimer& operator=(const SearchTimer&) = delete;
+
+    ~SearchTimer()
+    {
+        if (stats_ != nullptr)
+        {
+            stats_->total_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+            stats_->measure_phases = measure_phases_;
+        }
+    }
+
+private:
+    SearchStats *stats_; ///< statistics or nullptr
+    bool measure_phases_; ///< flag of the caller
+    std::chrono::steady_clock::time_point start_{ std::chrono::steady_clock::now() }; ///< start of the search
+};
+
+/**
+* \brief Writes statistics as a JSON object
+*
+* @tparam Stream std::ostream or OutputBuffer
+*/
+template <typename Stream>
+void write_json(Stream &stream, const SearchStats &stats)
+{
+    stream << "{\"generated\": " << stats.generated
+        << ", \"expanded\": " << stats.expanded
+        << ", \"duplicates\": " << stats.duplicates
+        << ", \"peak_open\": " << stats.peak_open
+        << ", \"peak_closed\": " << stats.peak_closed
+        << ", \"bytes\": " << stats.bytes
+        << ", \"evaluations\": " << stats.evaluations
+        << ", \"move_seconds\": " << stats.move_seconds
+        << ", \"heuristic_seconds\": " << stats.heuristic_seconds
+        << ", \"dedup_seconds\": " << stats.dedup_seconds
+        << ", \"total_seconds\": " << stats.total_seconds << '}';
+}
+
+/**
+* \brief Writes names of the columns written by write_csv()
+*/
+inline void write_csv_header(std::ostream &stream)
+{
+    stream << "generated,expanded,duplicates,peak_open,peak_closed,bytes,evaluations,"
+        "move_seconds,heuristic_seconds,dedup_seconds,total_seconds";
+}
+
+/**
+* \brief Writes statistics as a line of comma separated values without the line break
+*/
+inline void write_csv(std::ostream &stream, const SearchStats &stats)
+{
+    stream << stats.generated << ',' << stats.expanded << ',' << stats.duplicates << ','
+        << stats.peak_open << ',' << stats.peak_closed << ',' << stats.bytes << ',' << stats.evaluations << ','
+        << stats.move_seconds << ',' << stats.heuristic_seconds << ',' << stats.dedup_seconds << ','
+        << stats.total_seconds;
+}
+
+#endif // SEARCH_STATS_H_
@@ -0,0 +1,435 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SOLUTION_H_
+#define SOLUTION_H_
+
+#include "game_board.h"
+#include "output_buffer.h"
+#include "search_stats.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include <utility>
+
+/**
+* \brief Moves of the blank packed two bits per move
+*
+* \details Move i is kept in bits 2*(i%4) and 2*(i%4)+1 of byte i/4,
+* the same layout is used by snapshots of the solution cache
+*/
+class MoveSequence
+{
+public:
+    /**
+    * \brief Iterator over unpacked moves
+    */
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Direction;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Direction*;
+        using reference = Direction;
+
+        Iterator(const MoveSequence *moves, std::size_t index) noexcept
+            : moves_{ moves }, index_{ index }
+        {}
+
+        Direction operator*() const noexcept
+        {
+            return (*moves_)[index_];
+        }
+
+        Iterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+    private:
+        const MoveSequence *moves_; ///< iterated sequence
+        std::size_t index_; ///< index of the current move
+    };
+
+    MoveSequence() = default;
+
+    /**
+    * \brief Packs the moves
+    *
+    * \details Conversion is implicit, so searches build solutions straight from their paths
+    */
+    MoveSequence(const std::vector<Direction> &moves)
+    {
+        bytes_.reserve((moves.size() + 3) / 4);
+
+        for (Direction direction : moves)
+        {
+            push_back(direction);
+        }
+    }
+
+    /**
+    * \brief Restores the sequence from packed bytes
+    *
+    * @param bytes at least (size+3)/4 packed bytes
+    * @param size number of moves
+    */
+    MoveSequence(std::vector<std::uint8_t> bytes, std::size_t size)
+        : bytes_{ std::move(bytes) }, size_{ size }
+    {
+        bytes_.resize((size + 3) / 4);
+
+        // Bits past the last move are cleared, so equal sequences have equal bytes
+        if (size % 4 != 0)
+        {
+            bytes_.back() &= static_cast<std::uint8_t>((1u << (size % 4 * 2)) - 1);
+        }
+    }
+
+    void push_back(Direction direction)
+    {
+        if (size_ % 4 == 0)
+        {
+            bytes_.push_back(0);
+        }
+
+        bytes_.back() |= static_cast<std::uint8_t>(static_cast<std::uint8_t>(direction) << (size_ % 4 * 2));
+        ++size_;
+    }
+
+    Direction operator[](std::size_t index) const noexcept
+    {
+        return static_cast<Direction>((bytes_[index / 4] >> (index % 4 * 2)) & 3);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /**
+    * \brief Returns packed moves
+    */
+    const std::vector<std::uint8_t>& bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+    Iterator begin() const noexcept
+    {
+        return { this, 0 };
+    }
+
+    Iterator end() const noexcept
+    {
+        return { this, size_ };
+    }
+
+    std::vector<Direction> unpack() const
+    {
+        return std::vector<Direction>(begin(), end());
+    }
+
+private:
+    std::vector<std::uint8_t> bytes_{}; ///< packed moves
+    std::size_t size_{ 0 }; ///< number of moves
+};
+
+/**
+* \brief Result of the search
+*
+* \details Holds initial board, moves of the blank tile which lead to the target
+* and number of nodes the search generated. Default constructed solution means that the target wasn't reached.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class Solution
+{
+public:
+    Solution() = default;
+
+    Solution(GameBoard<Rows, Cols> initial, MoveSequence moves, std::size_t nodes = 0)
+        : initial_{ initial }, moves_{ std::move(moves) }, nodes_{ nodes }, is_found_{ true }
+    {}
+
+    /**
+    * \brief Checks whether the target was reached
+    */
+    bool is_found() const noexcept
+    {
+        return is_found_;
+    }
+
+    const GameBoard<Rows, Cols>& initial() const noexcept
+    {
+        return initial_;
+    }
+
+    const MoveSequence& moves() const noexcept
+    {
+        return moves_;
+    }
+
+    std::size_t length() const noexcept
+    {
+        return moves_.size();
+    }
+
+    /**
+    * \brief Returns number of nodes generated by the search
+    */
+    std::size_t nodes() const noexcept
+    {
+        return nodes_;
+    }
+
+    /**
+    * \brief Returns wall time of the search in seconds
+    *
+    * \details Time is set by the caller which measured the search, 0 if it wasn't measured
+    */
+    double seconds() const noexcept
+    {
+        return seconds_;
+    }
+
+    void set_seconds(double seconds) noexcept
+    {
+        seconds_ = seconds;
+    }
+
+    /**
+    * \brief Returns bound of the ratio between length of the solution and the shortest one
+    *
+    * \details Bound is 1 if the search proved the solution shortest. Depth first and beam searches don't prove it,
+    * their bound is the length divided by the admissible distance of the initial board;
+    * anytime search stopped by its budget gives the bound of its last pass
+    */
+    double bound() const noexcept
+    {
+        return bound_;
+    }
+
+    void set_bound(double bound) noexcept
+    {
+        bound_ = bound;
+    }
+
+    /**
+    * \brief Returns statistics of the search
+    *
+    * \details Statistics are set by the caller which collected them, zeros if they weren't collected
+    */
+    const SearchStats& stats() const noexcept
+    {
+        return stats_;
+    }
+
+    void set_stats(const SearchStats &stats) noexcept
+    {
+        stats_ = stats;
+    }
+
+    GameBoard<Rows, Cols> board() const noexcept;
+
+    void show_path() const;
+
+private:
+    GameBoard<Rows, Cols> initial_{}; ///< board from which the search started
+    MoveSequence moves_{}; ///< moves from the initial board to the target
+    std::size_t nodes_{ 0 }; ///< number of nodes generated by the search
+    double seconds_{ 0.0 }; ///< wall time of the search
+    double bound_{ 1.0 }; ///< bound of suboptimality of the moves
+    SearchStats stats_{}; ///< counters of the search
+    bool is_found_{ false }; ///< true if the target was reached, false otherwise
+};
+
+/**
+* \brief Returns final board of the solution
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @return Board reached after all moves, uninitialized board if nothing was found
+*/
+template <std::size_t Rows, std::size_t Cols>
+GameBoard<Rows, Cols> Solution<Rows, Cols>::board() const noexcept
+{
+    auto board = initial_;
+
+    for (Direction direction : moves_)
+    {
+        board = board.move(direction);
+    }
+
+    return board;
+}
+
+/**
+* \brief Outputs every board of the path to the standard output
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols>
+void Solution<Rows, Cols>::show_path() const
+{
+    auto buffer = OutputBuffer(std::cout);
+
+    write_path(buffer, *this);
+}
+
+/**
+* \brief Writes moves of the blank as letters D, L, U and R
+*
+* @param buffer destination of the text
+* @param moves written moves
+*/
+inline void write_moves(OutputBuffer &buffer, const MoveSequence &moves)
+{
+    constexpr char letters[] = { 'D', 'L', 'U', 'R' };
+
+    for (Direction direction : moves)
+    {
+        buffer << letters[static_cast<std::size_t>(direction)];
+    }
+}
+
+/**
+* \brief Writes solution as a line of text
+*
+* \details Line holds length and moves, "-" stands for no moves; unsolved board is written as "-1 -"
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param buffer destination of the text
+* @param solution written solution
+*/
+template <std::size_t Rows, std::size_t Cols>
+void write_text(OutputBuffer &buffer, const Solution<Rows, Cols> &solution)
+{
+    if (!solution.is_found())
+    {
+        buffer << "-1 -";
+        return;
+    }
+
+    buffer << solution.length() << ' ';
+
+    if (solution.length() == 0)
+    {
+        buffer << '-';
+    }
+
+    write_moves(buffer, solution.moves());
+}
+
+/**
+* \brief Writes solution as a JSON object
+*
+* \details Object holds "found", "length", "moves", "nodes", "seconds", "bound" and "stats" object of the search,
+* length is -1 if the target wasn't reached
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param buffer destination of the text
+* @param solution written solution
+*/
+template <std::size_t Rows, std::size_t Cols>
+void write_json(OutputBuffer &buffer, const Solution<Rows, Cols> &solution)
+{
+    buffer << "{\"found\": " << (solution.is_found() ? "true" : "false")
+        << ", \"length\": ";
+
+    if (solution.is_found())
+    {
+        buffer << solution.length();
+    }
+    else
+    {
+        buffer << "-1";
+    }
+
+    buffer << ", \"moves\": \"";
+    write_moves(buffer, solution.moves());
+    buffer << "\", \"nodes\": " << solution.nodes() << ", \"seconds\": " << solution.seconds()
+        << ", \"bound\": " << solution.bound() << ", \"stats\": ";
+    write_json(buffer, solution.stats());
+    buffer << '}';
+}
+
+/**
+* \brief Writes every board of the path
+*
+* \details Replays moves from the initial board, boards are separated by empty lines
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param buffer destination of the text
+* @param solution written solution, nothing is written if the target wasn't reached
+*/
+template <std::size_t Rows, std::size_t Cols>
+void write_path(OutputBuffer &buffer, const Solution<Rows, Cols> &solution)
+{
+    if (!solution.is_found())
+    {
+        return;
+    }
+
+    auto board = solution.initial();
+
+    buffer << '\n';
+    write_board(buffer, board);
+
+    for (Direction direction : solution.moves())
+    {
+        board = board.move(direction);
+
+        buffer << '\n';
+        write_board(buffer, board);
+    }
+
+    buffer << '\n';
+}
+
+#endif // SOLUTION_H_
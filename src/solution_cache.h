@@ -0,0 +1,527 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SOLUTION_CACHE_H_
+#define SOLUTION_CACHE_H_
+
+#include "game_board.h"
+#include "solution.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+* \brief Bounded cache of found solutions shared by concurrent queries
+*
+* \details Entries are keyed on the packed initial and target boards and hold moves of the blank.
+* Keys are spread over shards by their hash, every shard has its own lock, hash table and recency list,
+* so queries of different boards rarely wait for each other. When a shard is full
+* the least recently used entry of that shard is evicted.
+*
+* Only solutions proven shortest (Solution::bound() of 1) are stored, so an answer doesn't depend on the search
+* which filled the cache: paths of depth first, beam or interrupted anytime searches are never stored.
+*
+* Snapshot layout (native byte order):
+* "NPSC", version, number of rows, number of columns, number of entries, then for every entry:
+* packed initial board, packed target board, number of moves and moves packed as in MoveSequence.
+* Entries of every shard are written from the least to the most recently used one,
+* so loading the snapshot restores their order.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*/
+template <std::size_t Rows, std::size_t Cols = Rows>
+class SolutionCache
+{
+public:
+    using Key = typename GameBoard<Rows, Cols>::Key; ///< packed encoding of the board
+
+    static constexpr std::uint32_t version = 2; ///< version of the snapshot format, 1 could hold solutions which aren't the shortest
+
+    /**
+    * \brief Creates empty cache
+    *
+    * @param capacity maximum number of stored solutions, split evenly between shards
+    * @param shards number of independently locked parts, rounded up to a power of two and limited by the capacity
+    */
+    explicit SolutionCache(std::size_t capacity = 1 << 16, std::size_t shards = 16)
+    {
+        std::size_t count = 1;
+
+        while (count < shards && count < capacity)
+        {
+            count <<= 1;
+        }
+
+        shards_ = std::make_unique<Shard[]>(count);
+        shard_mask_ = count - 1;
+        shard_capacity_ = std::max<std::size_t>(1, (capacity + count - 1) / count);
+    }
+
+    bool find(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, Solution<Rows, Cols> &solution);
+    void insert(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const Solution<Rows, Cols> &solution);
+
+    template <typename Search>
+    Solution<Rows, Cols> solve(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, Search &&search);
+
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    std::size_t size() const;
+
+    /**
+    * \brief Returns number of queries answered from the cache
+    */
+    std::size_t hits() const;
+
+    /**
+    * \brief Returns number of queries which weren't in the cache
+    */
+    std::size_t misses() const;
+
+    void clear();
+
+private:
+    static constexpr char magic_[4] = { 'N', 'P', 'S', 'C' }; ///< first bytes of the snapshot
+
+    struct Query
+    {
+        Key initial; ///< board from which the search starts
+        Key target; ///< board which the search looks for
+
+        friend bool operator==(const Query &lhs, const Query &rhs) noexcept
+        {
+            return lhs.initial == rhs.initial && lhs.target == rhs.target;
+        }
+    };
+
+    struct QueryHash
+    {
+        std::size_t operator()(const Query &query) const noexcept
+        {
+            return query.initial.hash() ^ (query.target.hash() * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    using Entry = std::pair<Query, MoveSequence>; ///< query and moves of its solution
+
+    struct Shard
+    {
+        mutable std::mutex mutex{}; ///< guards everything below
+        std::list<Entry> entries{}; ///< stored entries, the most recently used one first
+        std::unordered_map< Query, typename std::list<Entry>::iterator, QueryHash > index{}; ///< entry of every query
+        std::size_t hits{ 0 }; ///< queries answered by this shard
+        std::size_t misses{ 0 }; ///< queries this shard didn't have
+    };
+
+    std::unique_ptr<Shard[]> shards_{}; ///< all shards
+    std::size_t shard_mask_{ 0 }; ///< number of shards minus one
+    std::size_t shard_capacity_{ 1 }; ///< maximum number of entries in one shard
+
+    Shard& shard_of(const Query &query) const noexcept
+    {
+        // Low bits pick the bucket inside the shard, so the shard is taken from the high ones
+        return shards_[(QueryHash{}(query) >> 48) & shard_mask_];
+    }
+
+    static void insert(Shard &shard, std::size_t capacity, const Query &query, MoveSequence moves);
+    static bool is_board(const Key &key) noexcept;
+};
+
+/**
+* \brief Looks for solution of the query
+*
+* \details Found entry becomes the most recently used one
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial board from which the search starts
+* @param target board which the search looks for
+* @param solution receives the stored solution, number of nodes is 0
+*
+* @return True if the solution was stored, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool SolutionCache<Rows, Cols>::find(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, Solution<Rows, Cols> &solution)
+{
+    const auto query = Query{ initial.key(), target.key() };
+    auto &shard = shard_of(query);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(query);
+
+    if (found == shard.index.end())
+    {
+        ++shard.misses;
+        return false;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+    ++shard.hits;
+
+    solution = Solution<Rows, Cols>(initial, found->second->second);
+
+    return true;
+}
+
+/**
+* \brief Stores solution of the query
+*
+* \details Solutions which weren't found or aren't proven shortest are ignored, stored solution of the same query is replaced
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param initial board from which the search starts
+* @param target board which the search looks for
+* @param solution result of the search
+*/
+template <std::size_t Rows, std::size_t Cols>
+void SolutionCache<Rows, Cols>::insert(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, const Solution<Rows, Cols> &solution)
+{
+    // Longer path would be returned to later queries of searches which promise the shortest one
+    if (!solution.is_found() || solution.bound() > 1.0)
+    {
+        return;
+    }
+
+    const auto query = Query{ initial.key(), target.key() };
+    auto &shard = shard_of(query);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insert(shard, shard_capacity_, query, solution.moves());
+}
+
+/**
+* \brief Returns stored solution or runs the search and stores its result
+*
+* \details Lock isn't held while the search runs, so concurrent misses of one query
+* search independently and the last of them is stored
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+* @tparam Search function without arguments which returns Solution<Rows, Cols>
+*
+* @param initial board from which the search starts
+* @param target board which the search looks for
+* @param search search called on a miss
+*
+* @return Solution of the query
+*/
+template <std::size_t Rows, std::size_t Cols>
+template <typename Search>
+Solution<Rows, Cols> SolutionCache<Rows, Cols>::solve(const GameBoard<Rows, Cols> &initial, const GameBoard<Rows, Cols> &target, Search &&search)
+{
+    auto solution = Solution<Rows, Cols>{};
+
+    if (find(initial, target, solution))
+    {
+        return solution;
+    }
+
+    solution = search();
+    insert(initial, target, solution);
+
+    return solution;
+}
+
+/**
+* \brief Writes every entry to the snapshot file
+*
+* \details Snapshot is written next to the path and renamed over it,
+* so an interrupted save leaves the previous snapshot intact.
+* Shards are locked one by one, entries inserted meanwhile may be missing from the snapshot.
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the snapshot
+*
+* @return True if the snapshot was written, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool SolutionCache<Rows, Cols>::save(const std::string &path) const
+{
+    const auto temporary = path + ".tmp";
+
+    {
+        auto stream = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+
+        if (!stream)
+        {
+            return false;
+        }
+
+        auto write = [&stream](const void *value, std::size_t size)
+        {
+            stream.write(static_cast<const char*>(value), static_cast<std::streamsize>(size));
+        };
+
+        const std::uint32_t rows = Rows;
+        const std::uint32_t cols = Cols;
+        std::uint64_t count = 0;
+
+        write(magic_, sizeof(magic_));
+        write(&version, sizeof(version));
+        write(&rows, sizeof(rows));
+        write(&cols, sizeof(cols));
+
+        // Count is patched once all shards are written
+        const auto count_offset = stream.tellp();
+        write(&count, sizeof(count));
+
+        for (std::size_t i = 0; i <= shard_mask_; i++)
+        {
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+
+            for (auto entry = shards_[i].entries.rbegin(); entry != shards_[i].entries.rend(); ++entry)
+            {
+                const auto &moves = entry->second;
+                const auto length = static_cast<std::uint32_t>(moves.size());
+
+                write(entry->first.initial.data.data(), sizeof(entry->first.initial.data));
+                write(entry->first.target.data.data(), sizeof(entry->first.target.data));
+                write(&length, sizeof(length));
+                write(moves.bytes().data(), moves.bytes().size());
+
+                ++count;
+            }
+        }
+
+        stream.seekp(count_offset);
+        write(&count, sizeof(count));
+
+        if (!stream.flush())
+        {
+            return false;
+        }
+    }
+
+    auto error = std::error_code{};
+    std::filesystem::rename(temporary, path, error);
+
+    return !error;
+}
+
+/**
+* \brief Adds entries of the snapshot file to the cache
+*
+* \details Entries of the snapshot are inserted in their order,
+* if the snapshot holds more entries than fit into the cache the least recently used ones are dropped
+*
+* @tparam Rows number of rows of the board
+* @tparam Cols number of columns of the board
+*
+* @param path path to the file written by save()
+*
+* @return True if the whole snapshot was read, false if the file is missing or malformed.
+* Entries read before the malformed one are kept.
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool SolutionCache<Rows, Cols>::load(const std::string &path)
+{
+    auto stream = std::ifstream(path, std::ios::binary);
+
+    if (!stream)
+    {
+        return false;
+    }
+
+    auto read = [&stream](void *value, std::size_t size)
+    {
+        stream.read(static_cast<char*>(value), static_cast<std::streamsize>(size));
+        return static_cast<bool>(stream);
+    };
+
+    char magic[4]{};
+    std::uint32_t file_version{}, rows{}, cols{};
+    std::uint64_t count{};
+
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, magic_, sizeof(magic)) != 0
+        || !read(&file_version, sizeof(file_version)) || file_version != version
+        || !read(&rows, sizeof(rows)) || rows != Rows
+        || !read(&cols, sizeof(cols)) || cols != Cols
+        || !read(&count, sizeof(count)))
+    {
+        return false;
+    }
+
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        auto query = Query{};
+        std::uint32_t length{};
+
+        if (!read(query.initial.data.data(), sizeof(query.initial.data))
+            || !read(query.target.data.data(), sizeof(query.target.data))
+            || !read(&length, sizeof(length))
+            || !is_board(query.initial) || !is_board(query.target))
+        {
+            return false;
+        }
+
+        auto packed = std::vector<std::uint8_t>((length + 3u) / 4);
+
+        if (!read(packed.data(), packed.size()))
+        {
+            return false;
+        }
+
+        auto moves = MoveSequence(std::move(packed), length);
+
+        auto &shard = shard_of(query);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        insert(shard, shard_capacity_, query, std::move(moves));
+    }
+
+    return true;
+}
+
+/**
+* \brief Returns number of stored solutions
+*/
+template <std::size_t Rows, std::size_t Cols>
+std::size_t SolutionCache<Rows, Cols>::size() const
+{
+    std::size_t result = 0;
+
+    for (std::size_t i = 0; i <= shard_mask_; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        result += shards_[i].entries.size();
+    }
+
+    return result;
+}
+
+template <std::size_t Rows, std::size_t Cols>
+std::size_t SolutionCache<Rows, Cols>::hits() const
+{
+    std::size_t result = 0;
+
+    for (std::size_t i = 0; i <= shard_mask_; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        result += shards_[i].hits;
+    }
+
+    return result;
+}
+
+template <std::size_t Rows, std::size_t Cols>
+std::size_t SolutionCache<Rows, Cols>::misses() const
+{
+    std::size_t result = 0;
+
+    for (std::size_t i = 0; i <= shard_mask_; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        result += shards_[i].misses;
+    }
+
+    return result;
+}
+
+/**
+* \brief Drops every entry and resets counters
+*/
+template <std::size_t Rows, std::size_t Cols>
+void SolutionCache<Rows, Cols>::clear()
+{
+    for (std::size_t i = 0; i <= shard_mask_; i++)
+    {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+
+        shards_[i].entries.clear();
+        shards_[i].index.clear();
+        shards_[i].hits = 0;
+        shards_[i].misses = 0;
+    }
+}
+
+/**
+* \brief Stores moves of the query in the locked shard
+*
+* \details Entry becomes the most recently used one, the least recently used entry is evicted if the shard is full
+*/
+template <std::size_t Rows, std::size_t Cols>
+void SolutionCache<Rows, Cols>::insert(Shard &shard, std::size_t capacity, const Query &query, MoveSequence moves)
+{
+    auto found = shard.index.find(query);
+
+    if (found != shard.index.end())
+    {
+        found->second->second = std::move(moves);
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+
+        return;
+    }
+
+    if (shard.entries.size() >= capacity)
+    {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+    }
+
+    shard.entries.emplace_front(query, std::move(moves));
+    shard.index.emplace(query, shard.entries.begin());
+}
+
+/**
+* \brief Checks whether the key read from the snapshot describes a board
+*
+* @return True if every tile id from 0 to Rows*Cols-1 appears exactly once and nothing else is set, false otherwise
+*/
+template <std::size_t Rows, std::size_t Cols>
+bool SolutionCache<Rows, Cols>::is_board(const Key &key) noexcept
+{
+    constexpr std::size_t cells = Rows * Cols;
+
+    auto board = Key{};
+    std::uint64_t seen = 0;
+
+    for (std::size_t cell = 0; cell < cells; cell++)
+    {
+        const auto tile = key.get(cell);
+
+        if (tile >= cells || (seen >> tile & 1) != 0)
+        {
+            return false;
+        }
+
+        seen |= std::uint64_t{ 1 } << tile;
+        board.set(cell, tile);
+    }
+
+    // Bits past the last cell have to be clear, otherwise the key never equals key of the board
+    return board == key;
+}
+
+#endif // SOLUTION_CACHE_H_
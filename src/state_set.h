@@ -0,0 +1,256 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STATE_SET_H_
+#define STATE_SET_H_
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+/**
+* \brief Set of visited boards
+*
+* \details Open-addressing hash set with linear probing keyed on the packed board encoding.
+* Empty key is reserved as a marker of the free slot.
+*
+* @tparam Key packed board encoding, has to provide hash() and empty()
+*/
+template <typename Key>
+class StateSet
+{
+public:
+    explicit StateSet(std::size_t expected_size = 1024)
+    {
+        std::size_t capacity = 16;
+
+        while (capacity * max_load_ < expected_size * max_load_denominator_)
+        {
+            capacity <<= 1;
+        }
+
+        slots_.resize(capacity);
+    }
+
+    /**
+    * \brief Inserts the key into the set
+    *
+    * @return True if the key wasn't present before, false otherwise
+    */
+    bool insert(const Key &key)
+    {
+        if ((size_ + 1) * max_load_denominator_ > slots_.size() * max_load_)
+        {
+            grow();
+        }
+
+        auto &slot = probe(slots_, key);
+
+        if (!slot.empty())
+        {
+            return false;
+        }
+
+        slot = key;
+        ++size_;
+
+        return true;
+    }
+
+    bool contains(const Key &key) const
+    {
+        return !probe(slots_, key).empty();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+    * \brief Returns number of bytes taken by the table
+    */
+    std::size_t memory() const noexcept
+    {
+        return slots_.capacity() * sizeof(slots_[0]);
+    }
+
+    void clear()
+    {
+        std::fill(slots_.begin(), slots_.end(), Key{});
+        size_ = 0;
+    }
+
+private:
+    static constexpr std::size_t max_load_ = 7; ///< numerator of the maximum load factor
+    static constexpr std::size_t max_load_denominator_ = 10; ///< denominator of the maximum load factor
+
+    std::vector<Key> slots_{}; ///< table itself, size is always a power of two
+    std::size_t size_{ 0 }; ///< number of stored keys
+
+    template <typename Slots>
+    static auto& probe(Slots &slots, const Key &key)
+    {
+        const auto mask = slots.size() - 1;
+        auto index = key.hash() & mask;
+
+        while (!slots[index].empty() && slots[index] != key)
+        {
+            index = (index + 1) & mask;
+        }
+
+        return slots[index];
+    }
+
+    void grow()
+    {
+        auto old_slots = std::vector<Key>(slots_.size() * 2);
+        old_slots.swap(slots_);
+
+        for (const Key &key : old_slots)
+        {
+            if (!key.empty())
+            {
+                probe(slots_, key) = key;
+            }
+        }
+    }
+};
+
+/**
+* \brief Map from boards to values
+*
+* \details Open-addressing hash map with linear probing keyed on the packed board encoding.
+* Used as closed table of informed searches, where value is index of the best node found for the board.
+*
+* @tparam Key packed board encoding, has to provide hash() and empty()
+* @tparam Value stored value
+*/
+template <typename Key, typename Value>
+class StateMap
+{
+public:
+    explicit StateMap(std::size_t expected_size = 1024)
+    {
+        std::size_t capacity = 16;
+
+        while (capacity * max_load_ < expected_size * max_load_denominator_)
+        {
+            capacity <<= 1;
+        }
+
+        slots_.resize(capacity);
+    }
+
+    /**
+    * \brief Inserts the key with the given value unless the key is already present
+    *
+    * \details Returned pointer stays valid until the next insertion
+    *
+    * @return Pointer to the stored value and true if the key was inserted, false otherwise
+    */
+    std::pair<Value*, bool> insert(const Key &key, const Value &value)
+    {
+        if ((size_ + 1) * max_load_denominator_ > slots_.size() * max_load_)
+        {
+            grow();
+        }
+
+        auto &slot = probe(slots_, key);
+
+        if (!slot.first.empty())
+        {
+            return { &slot.second, false };
+        }
+
+        slot = { key, value };
+        ++size_;
+
+        return { &slot.second, true };
+    }
+
+    /**
+    * \brief Finds value of the given key
+    *
+    * @return Pointer to the stored value, nullptr if the key isn't present
+    */
+    Value* find(const Key &key)
+    {
+        auto &slot = probe(slots_, key);
+
+        return slot.first.empty() ? nullptr : &slot.second;
+    }
+
+    const Value* find(const Key &key) const
+    {
+        const auto &slot = probe(slots_, key);
+
+        return slot.first.empty() ? nullptr : &slot.second;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /**
+    * \brief Returns number of bytes taken by the table
+    */
+    std::size_t memory() const noexcept
+    {
+        return slots_.capacity() * sizeof(slots_[0]);
+    }
+
+private:
+    static constexpr std::size_t max_load_ = 7; ///< numerator of the maximum load factor
+    static constexpr std::size_t max_load_denominator_ = 10; ///< denominator of the maximum load factor
+
+    std::vector< std::pair<Key, Value> > slots_{}; ///< table itself, size is always a power of two
+    std::size_t size_{ 0 }; ///< number of stored keys
+
+    template <typename Slots>
+    static auto& probe(Slots &slots, const Key &key)
+    {
+        const auto mask = slots.size() - 1;
+        auto index = key.hash() & mask;
+
+        while (!slots[index].first.empty() && slots[index].first != key)
+        {
+            index = (index + 1) & mask;
+        }
+
+        return slots[index];
+    }
+
+    void grow()
+    {
+        auto old_slots = std::vector< std::pair<Key, Value> >(slots_.size() * 2);
+        old_slots.swap(slots_);
+
+        for (const auto &slot : old_slots)
+        {
+            if (!slot.first.empty())
+            {
+                probe(slots_, slot.first) = slot;
+            }
+        }
+    }
+};
+
+#endif // STATE_SET_H_
@@ -0,0 +1,216 @@
+/* n-puzzle
+*  Copyright (C) 2018 Yurii Khomiak
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+*  and associated documentation files (the "Software"), to deal in the Software without restriction,
+*  including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*  and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+*  subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+*  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+*  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+*  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+* \brief Work-stealing pool of threads
+*
+* \details Every worker owns a queue of tasks. Tasks submitted from outside are spread
+* over the queues round-robin, tasks submitted by a worker go to its own queue.
+* Worker takes tasks from the back of its queue and steals from the front of the others
+* once its own queue is empty, so long tasks don't leave the rest of the threads idle.
+*/
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        threads = (threads == 0) ? 1 : threads;
+
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            threads_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+    * \brief Finishes all submitted tasks and stops the threads
+    */
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_stopped_ = true;
+        }
+
+        wake_.notify_all();
+
+        for (std::thread &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    /**
+    * \brief Returns number of threads
+    */
+    std::size_t size() const noexcept
+    {
+        return threads_.size();
+    }
+
+    /**
+    * \brief Queues the task
+    */
+    void submit(Task task)
+    {
+        auto index = (worker_pool_ == this) ? worker_index_ : next_queue_++ % queues_.size();
+
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++queued_;
+            ++pending_;
+        }
+
+        wake_.notify_one();
+    }
+
+    /**
+    * \brief Blocks until every submitted task is finished
+    */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex{};
+        std::deque<Task> tasks{};
+    };
+
+    std::vector< std::unique_ptr<Queue> > queues_{}; ///< queue of every worker
+    std::vector<std::thread> threads_{}; ///< workers
+    std::atomic<std::size_t> next_queue_{ 0 }; ///< queue of the next task submitted from outside
+
+    std::mutex mutex_{}; ///< guards counters below
+    std::condition_variable wake_{}; ///< signalled when a task is queued or the pool stops
+    std::condition_variable done_{}; ///< signalled when the last pending task is finished
+    std::size_t queued_{ 0 }; ///< number of tasks in the queues
+    std::size_t pending_{ 0 }; ///< number of tasks not finished yet
+    bool is_stopped_{ false }; ///< true if the pool is being destroyed
+
+    static thread_local ThreadPool *worker_pool_; ///< pool of the current thread, nullptr outside workers
+    static thread_local std::size_t worker_index_; ///< index of the current worker in its pool
+
+    // Takes a task from the own queue or steals one from the others
+    bool pop(std::size_t index, Task &task)
+    {
+        {
+            auto &own = *queues_[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < queues_.size(); i++)
+        {
+            auto &victim = *queues_[(index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void run(std::size_t index)
+    {
+        worker_pool_ = this;
+        worker_index_ = index;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return queued_ > 0 || is_stopped_; });
+
+                if (queued_ == 0)
+                {
+                    return;
+                }
+
+                // Claim one of the queued tasks, it is in some queue already
+                --queued_;
+            }
+
+            auto task = Task{};
+
+            while (!pop(index, task))
+            {
+                std::this_thread::yield();
+            }
+
+            task();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (--pending_ == 0)
+            {
+                done_.notify_all();
+            }
+        }
+    }
+};
+
+inline thread_local ThreadPool *ThreadPool::worker_pool_ = nullptr;
+inline thread_local std::size_t ThreadPool::worker_index_ = 0;
+
+#endif // THREAD_POOL_H_